@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_ENDPOINTS_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_ENDPOINTS_H_
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+/** The configuration server selects the transport of each connection:
+ * inproc (models in the same process, see tools/model_runner), ipc (models on
+ * the same host) or tcp. A socket binds to all endpoints of the whitespace-
+ * separated list, which the server returns for '<model>_bindEndpoints'. **/
+inline std::vector<std::string> splitEndpoints(std::string endpoints) {
+	std::vector<std::string> endpointList;
+	std::istringstream endpointStream(endpoints);
+	std::string endpoint;
+
+	while (endpointStream >> endpoint) {
+		endpointList.push_back(endpoint);
+	}
+
+	return endpointList;
+}
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_ENDPOINTS_H_ */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTDISPATCHER_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTDISPATCHER_H_
+
+#include <array>
+#include <stddef.h>
+
+/** Table of the event handlers of a model, indexed by the type of the event
+ * (EventType in resources/idl/event.fbs). Dispatching an event costs one indexed
+ * call instead of comparing its name with the names of all handled events. **/
+template<typename Model, typename Event, size_t NumOfEventTypes>
+class EventDispatcher {
+public:
+	typedef void (Model::*EventHandler)(const Event*);
+
+	EventDispatcher(Model *model) :
+			mModel(model) {
+		mHandlers.fill(nullptr);
+	}
+
+	void registerHandler(size_t eventType, EventHandler handler) {
+		if (eventType < NumOfEventTypes) {
+			mHandlers[eventType] = handler;
+		}
+	}
+
+	/** Returns false, if no handler is registered for the type of the event **/
+	bool dispatch(const Event *event) const {
+		size_t eventType = static_cast<size_t>(event->type());
+		if (eventType >= NumOfEventTypes || mHandlers[eventType] == nullptr) {
+			return false;
+		}
+
+		(mModel->*mHandlers[eventType])(event);
+		return true;
+	}
+
+private:
+	Model *mModel;
+	std::array<EventHandler, NumOfEventTypes> mHandlers;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTDISPATCHER_H_ */
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTENCODER_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTENCODER_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+#include <zmq.hpp>
+
+#include "flatbuffers/flatbuffers.h"
+#include "flatbuffers/flexbuffers.h"
+
+// Large enough for every event of the template models (flits, credits, states)
+#define INITIAL_EVENT_BUFFER_SIZE 256
+
+/** Serializes the events of a model with builders which are reused for every
+ * event: Clear() only resets the builders, but keeps their memory. So after
+ * the first events no memory is allocated anymore for sending an event.
+ * Each model owns its encoder, i.e., there is one encoder per thread.
+ *
+ * An event can be handed over to ZMQ without a copy (takeEvent): The message
+ * refers to the memory of the builder, which is lent to ZMQ until the message
+ * is sent. Meanwhile the next events are serialized with the other builders
+ * of the pool. The pool grows to the number of events in flight (e.g., the
+ * events of a cycle, see EventPublisher::queueEvent).
+ *
+ * Usage:
+ *   auto &fbb = mEventEncoder.startEvent();
+ *   auto data = fbb.CreateStruct(event::Flit(flit)).Union();
+ *   mEventEncoder.finishEvent(event::CreateEvent(fbb, ..., event::EventData_Flit, data, ...));
+ *   mPublisher.queueEvent(topic, mEventEncoder); **/
+class EventEncoder {
+public:
+	EventEncoder() :
+			mFlexbuild(INITIAL_EVENT_BUFFER_SIZE) {
+		mCurrent = this->getFreeBuilder();
+	}
+
+	EventEncoder(const EventEncoder&) = delete;
+	EventEncoder& operator=(const EventEncoder&) = delete;
+
+	virtual ~EventEncoder() {
+		// Builders which are still lent to ZMQ are deleted when ZMQ releases them
+		for (auto builder : mBuilders) {
+			if (builder->state.exchange(Orphaned) != Lent) {
+				delete builder;
+			}
+		}
+	}
+
+	/** Resets the builder (the last event is no longer valid) **/
+	flatbuffers::FlatBufferBuilder &startEvent() {
+		if (mCurrent == nullptr) {
+			mCurrent = this->getFreeBuilder();
+		}
+
+		mCurrent->fbb.Clear();
+		return mCurrent->fbb;
+	}
+
+	/** Serializes data for the generic payload (FlexData), which has no
+	 * fixed layout. Flits, credits and state paths have their own payload types. **/
+	template<typename T>
+	flatbuffers::Offset<flatbuffers::Vector<uint8_t>> createFlexbuffer(
+			const T &data) {
+		mFlexbuild.Clear();
+		mFlexbuild.Add(data);
+		mFlexbuild.Finish();
+
+		auto &buffer = mFlexbuild.GetBuffer();
+		return mCurrent->fbb.CreateVector(buffer.data(), buffer.size());
+	}
+
+	template<typename Event>
+	void finishEvent(flatbuffers::Offset<Event> event) {
+		mCurrent->fbb.Finish(event);
+	}
+
+	const uint8_t *getBuffer() const {
+		return mCurrent->fbb.GetBufferPointer();
+	}
+
+	uint32_t getSize() const {
+		return mCurrent->fbb.GetSize();
+	}
+
+	/** Moves the finished event into the frame (no copy). The builder is lent
+	 * to ZMQ, the next event is serialized with another builder. **/
+	void takeEvent(zmq::message_t &frame) {
+		Builder *builder = mCurrent;
+		builder->state.store(Lent);
+		mCurrent = nullptr;
+
+		frame.rebuild(builder->fbb.GetBufferPointer(), builder->fbb.GetSize(),
+				&EventEncoder::releaseBuilder, builder);
+	}
+
+	/** Number of builders (events in flight and the current event) **/
+	size_t getNumOfBuilders() const {
+		return mBuilders.size();
+	}
+
+private:
+	enum BuilderState {
+		Free, Lent, Orphaned
+	};
+
+	struct Builder {
+		Builder() :
+				fbb(INITIAL_EVENT_BUFFER_SIZE), state(Free) {
+		}
+
+		flatbuffers::FlatBufferBuilder fbb;
+		// Set by the model (lent) and by the I/O thread of ZMQ (released)
+		std::atomic<int> state;
+	};
+
+	/** Called by ZMQ, when the message is sent (possibly in its I/O thread) **/
+	static void releaseBuilder(void*, void *hint) {
+		Builder *builder = static_cast<Builder*>(hint);
+		if (builder->state.exchange(Free) == Orphaned) {
+			delete builder;
+		}
+	}
+
+	Builder *getFreeBuilder() {
+		// The builders are searched from the last used one: Usually the
+		// builder of the oldest event is already released again
+		for (size_t i = 0; i < mBuilders.size(); i++) {
+			mNextBuilder = (mNextBuilder + 1) % mBuilders.size();
+			if (mBuilders[mNextBuilder]->state.load() == Free) {
+				return mBuilders[mNextBuilder];
+			}
+		}
+
+		mBuilders.push_back(new Builder());
+		mNextBuilder = mBuilders.size() - 1;
+		return mBuilders.back();
+	}
+
+	std::vector<Builder*> mBuilders;
+	size_t mNextBuilder = 0;
+	Builder *mCurrent = nullptr;
+	flexbuffers::Builder mFlexbuild;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTENCODER_H_ */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTPAYLOAD_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTPAYLOAD_H_
+
+#include <string>
+#include <stdint.h>
+
+#include "resources/idl/event_generated.h"
+
+/** Accessors of the typed payloads (union EventData) of a received event.
+ * The data_as_*() functions of an event return a null pointer, if the event
+ * carries another payload type or none at all (e.g., an event of another
+ * sender with the same name), so the payload is only read through these
+ * functions. **/
+
+/** Reads the flit of the event. Returns false, if the event has no flit. **/
+inline bool getFlit(const event::Event* receivedEvent, uint32_t &flit) {
+	auto data = receivedEvent->data_as_Flit();
+	if (data == nullptr) {
+		return false;
+	}
+
+	flit = data->value();
+	return true;
+}
+
+/** Flits of a burst. Returns a null pointer, if the event carries no
+ * burst (e.g., a single flit). **/
+inline const flatbuffers::Vector<uint32_t>* getBurst(
+		const event::Event* receivedEvent) {
+	auto flits = receivedEvent->data_as_Flits();
+	if (flits == nullptr) {
+		return nullptr;
+	}
+
+	return flits->values();
+}
+
+/** Number of credits of a credit event (events without payload count as one
+ * credit) **/
+inline uint32_t getCreditCount(const event::Event* receivedEvent) {
+	auto credit = receivedEvent->data_as_Credit();
+	if (credit == nullptr) {
+		return 1;
+	}
+
+	return credit->count();
+}
+
+/** Reads the state path of SaveState, LoadState and ExportState. Returns
+ * false, if the event has no path. **/
+inline bool getStatePath(const event::Event* receivedEvent,
+		std::string &path) {
+	auto data = receivedEvent->data_as_String();
+	if (data == nullptr) {
+		return false;
+	}
+
+	path = data->str();
+	return true;
+}
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTPAYLOAD_H_ */
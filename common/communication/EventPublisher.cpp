@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "EventPublisher.h"
+#include "Endpoints.h"
+
+#include <iostream>
+
+EventPublisher::EventPublisher(zmq::context_t &ctx) :
+		mPublisher(ctx, ZMQ_PUB), mSyncPublisher(ctx) {
+}
+
+EventPublisher::~EventPublisher() {
+	mPublisher.close();
+}
+
+bool EventPublisher::bindSocket(std::string endpoints) {
+	if (splitEndpoints(endpoints).empty()) {
+		std::cout << "No endpoints to bind the publisher" << std::endl;
+		return false;
+	}
+
+	for (auto endpoint : splitEndpoints(endpoints)) {
+		try {
+			mPublisher.bind(endpoint);
+		} catch (std::exception &e) {
+			std::cout << "Could not bind publisher to " << endpoint << ": "
+					<< e.what() << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void EventPublisher::publishEvent(const std::string &eventName,
+		const uint8_t *buffer, uint32_t size) {
+	zmq::message_t name(eventName.data(), eventName.size());
+	zmq::message_t data(buffer, size);
+
+	mPublisher.send(name, ZMQ_SNDMORE);
+	mPublisher.send(data);
+}
+
+void EventPublisher::publishEvent(const EventTopic &topic,
+		EventEncoder &encoder) {
+	zmq::message_t name;
+	zmq::message_t data;
+	topic.copyFrameTo(name);
+	encoder.takeEvent(data);
+
+	mPublisher.send(name, ZMQ_SNDMORE);
+	mPublisher.send(data);
+}
+
+void EventPublisher::queueEvent(const std::string &eventName,
+		const uint8_t *buffer, uint32_t size) {
+	addToDestination(getTopicDestination(eventName));
+	mQueuedNames.emplace_back(eventName.data(), eventName.size());
+	mQueuedEvents.emplace_back(buffer, size);
+}
+
+void EventPublisher::queueEvent(const EventTopic &topic,
+		EventEncoder &encoder) {
+	addToDestination(topic.getDestination());
+	mQueuedNames.emplace_back();
+	topic.copyFrameTo(mQueuedNames.back());
+	mQueuedEvents.emplace_back();
+	encoder.takeEvent(mQueuedEvents.back());
+}
+
+void EventPublisher::addToDestination(const std::string &destination) {
+	auto found = mDestinationIndices.find(destination);
+	if (found == mDestinationIndices.end()) {
+		found = mDestinationIndices.emplace(destination,
+				mDestinationEvents.size()).first;
+		mDestinationEvents.emplace_back();
+	}
+
+	auto &destinationEvents = mDestinationEvents[found->second];
+	if (destinationEvents.empty()) {
+		mFlushOrder.push_back(found->second);
+	}
+	destinationEvents.push_back(mQueuedEvents.size());
+}
+
+void EventPublisher::flushEvents() {
+	for (auto destination : mFlushOrder) {
+		auto &destinationEvents = mDestinationEvents[destination];
+
+		// Only the last frame is sent without SNDMORE
+		mPublisher.send(mQueuedNames[destinationEvents.front()], ZMQ_SNDMORE);
+		for (size_t i = 0; i + 1 < destinationEvents.size(); i++) {
+			mPublisher.send(mQueuedEvents[destinationEvents[i]], ZMQ_SNDMORE);
+		}
+		mPublisher.send(mQueuedEvents[destinationEvents.back()]);
+
+		destinationEvents.clear();
+	}
+
+	mFlushOrder.clear();
+	mQueuedNames.clear();
+	mQueuedEvents.clear();
+}
+
+bool EventPublisher::preparePubSynchronization(std::string port) {
+	return mSyncPublisher.preparePubSynchronization(port);
+}
+
+bool EventPublisher::synchronizePub(uint64_t numOfSubscribers,
+		uint64_t currentSimTime) {
+	return mSyncPublisher.synchronizePub(numOfSubscribers, currentSimTime);
+}
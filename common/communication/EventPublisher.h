@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTPUBLISHER_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTPUBLISHER_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+#include <zmq.hpp>
+
+#include "communication/Publisher.h"
+#include "EventEncoder.h"
+#include "EventTopic.h"
+
+/** Publishes the events of a model (ZMQ-PUB) on all endpoints, which the
+ * configuration server assigned to the model (see Endpoints.h).
+ * The synchronization with the subscribers is done by the publisher of fraser.
+ *
+ * Events can be sent immediately (publishEvent) or collected in the outbound
+ * batch (queueEvent) until the model finished a simulation cycle (flushEvents).
+ * The queued events with the same destination (see getTopicDestination) are
+ * sent as one multipart message: [name, event, event, ...]. The name is the
+ * one of the first event, so the message passes the prefix subscription of
+ * the receiver. The subscriber delivers the events one by one and the
+ * receiver dispatches them by their type.
+ *
+ * Events of an EventEncoder with an EventTopic are sent without a copy: The
+ * frame of the event refers to the builder of the encoder and the frame of
+ * the name to the frame of the topic. The other functions copy the name and
+ * the buffer into the message (e.g., for events of the clock). **/
+class EventPublisher {
+public:
+	EventPublisher(zmq::context_t &ctx);
+	virtual ~EventPublisher();
+
+	bool bindSocket(std::string endpoints);
+	void publishEvent(const std::string &eventName, const uint8_t *buffer,
+			uint32_t size);
+	/** Sends the finished event of the encoder (no copy) **/
+	void publishEvent(const EventTopic &topic, EventEncoder &encoder);
+	/** Copies the event into the outbound batch **/
+	void queueEvent(const std::string &eventName, const uint8_t *buffer,
+			uint32_t size);
+	/** Moves the finished event of the encoder into the outbound batch **/
+	void queueEvent(const EventTopic &topic, EventEncoder &encoder);
+	/** Sends one message per destination, in the order of the first queued
+	 * event of each destination. The order of the events of a destination
+	 * is kept. **/
+	void flushEvents();
+
+	// Synchronization
+	bool preparePubSynchronization(std::string port);
+	bool synchronizePub(uint64_t numOfSubscribers, uint64_t currentSimTime);
+
+private:
+	zmq::socket_t mPublisher;
+	Publisher mSyncPublisher;
+
+	// Outbound batch (the vectors keep their memory between the cycles)
+	std::vector<zmq::message_t> mQueuedNames;
+	std::vector<zmq::message_t> mQueuedEvents;
+
+	// Indices of the queued events per destination and the destinations
+	// in the order of their first queued event
+	std::unordered_map<std::string, size_t> mDestinationIndices;
+	std::vector<std::vector<size_t>> mDestinationEvents;
+	std::vector<size_t> mFlushOrder;
+	void addToDestination(const std::string &destination);
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTPUBLISHER_H_ */
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "EventSubscriber.h"
+
+#include <iostream>
+
+EventSubscriber::EventSubscriber(zmq::context_t &ctx) :
+		mControlLane(ctx), mEventLane(ctx), mCurrentLane(&mEventLane), mSyncSubscriber(
+				ctx) {
+}
+
+EventSubscriber::~EventSubscriber() {
+	for (auto lane : { &mControlLane, &mEventLane }) {
+		for (auto &subscriber : lane->subscribers) {
+			subscriber.close();
+		}
+	}
+}
+
+void EventSubscriber::setOwnershipName(std::string name) {
+	mSyncSubscriber.setOwnershipName(name);
+}
+
+bool EventSubscriber::connectToPub(std::string endpoint) {
+	return connectLane(mEventLane, endpoint);
+}
+
+void EventSubscriber::subscribeTo(std::string eventName) {
+	subscribeLane(mEventLane, eventName);
+}
+
+bool EventSubscriber::connectToControlPub(std::string endpoint) {
+	return connectLane(mControlLane, endpoint);
+}
+
+void EventSubscriber::subscribeToControl(std::string eventName) {
+	subscribeLane(mControlLane, eventName);
+}
+
+bool EventSubscriber::connectLane(Lane &lane, std::string endpoint) {
+	// The events of publishers on other hosts are verified
+	LinkType links = LocalLinks;
+	if (endpoint.compare(0, 6, "tcp://") == 0) {
+		links = RemoteLinks;
+	}
+
+	try {
+		lane.subscribers[links].connect(endpoint);
+	} catch (std::exception &e) {
+		std::cout << "Could not connect to publisher " << endpoint << ": "
+				<< e.what() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void EventSubscriber::subscribeLane(Lane &lane, const std::string &eventName) {
+	for (auto &subscriber : lane.subscribers) {
+		subscriber.setsockopt(ZMQ_SUBSCRIBE, eventName.data(),
+				eventName.size());
+	}
+}
+
+EventSubscriber::Lane &EventSubscriber::waitForLane() {
+	if (mControlLane.moreEvents) {
+		return mControlLane;
+	}
+
+	zmq::pollitem_t items[] = {
+			{ static_cast<void*>(mControlLane.subscribers[LocalLinks]), 0,
+					ZMQ_POLLIN, 0 },
+			{ static_cast<void*>(mControlLane.subscribers[RemoteLinks]), 0,
+					ZMQ_POLLIN, 0 },
+			{ static_cast<void*>(mEventLane.subscribers[LocalLinks]), 0,
+					ZMQ_POLLIN, 0 },
+			{ static_cast<void*>(mEventLane.subscribers[RemoteLinks]), 0,
+					ZMQ_POLLIN, 0 } };
+
+	// The rest of a batch can be read at once, but a control event is preferred
+	if (mEventLane.moreEvents) {
+		zmq::poll(items, 2, 0);
+	} else {
+		zmq::poll(items, 4, -1);
+	}
+
+	if (setReadyLinks(mControlLane, items)) {
+		return mControlLane;
+	}
+
+	setReadyLinks(mEventLane, items + NumOfLinkTypes);
+	return mEventLane;
+}
+
+bool EventSubscriber::setReadyLinks(Lane &lane, const zmq::pollitem_t *items) {
+	for (int links = LocalLinks; links < NumOfLinkTypes; links++) {
+		if (items[links].revents & ZMQ_POLLIN) {
+			lane.readyLinks = static_cast<LinkType>(links);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool EventSubscriber::receiveEvent() {
+	return receiveFromLane(waitForLane());
+}
+
+bool EventSubscriber::hasPendingEvent() {
+	if (mEventLane.moreEvents) {
+		return true;
+	}
+
+	zmq::pollitem_t items[] = {
+			{ static_cast<void*>(mEventLane.subscribers[LocalLinks]), 0,
+					ZMQ_POLLIN, 0 },
+			{ static_cast<void*>(mEventLane.subscribers[RemoteLinks]), 0,
+					ZMQ_POLLIN, 0 } };
+	zmq::poll(items, 2, 0);
+
+	return setReadyLinks(mEventLane, items);
+}
+
+bool EventSubscriber::receivePendingEvent() {
+	if (!hasPendingEvent()) {
+		return false;
+	}
+
+	return receiveFromLane(mEventLane);
+}
+
+bool EventSubscriber::receiveFromLane(Lane &lane) {
+	mCurrentLane = &lane;
+
+	// A new batch is read from the socket, which has an event
+	if (!lane.moreEvents) {
+		lane.batchLinks = lane.readyLinks;
+	}
+	zmq::socket_t &subscriber = lane.subscribers[lane.batchLinks];
+
+	if (!lane.moreEvents) {
+		if (!subscriber.recv(&lane.eventName)) {
+			return false;
+		}
+
+		if (!hasMoreFrames(subscriber)) {
+			return false;
+		}
+	}
+
+	if (!subscriber.recv(&lane.eventData)) {
+		lane.moreEvents = false;
+		return false;
+	}
+
+	lane.moreEvents = hasMoreFrames(subscriber);
+
+	if (lane.batchLinks == RemoteLinks && mEventVerifier != nullptr
+			&& !mEventVerifier(getEventBuffer(), getEventSize())) {
+		std::cout << "Dropped invalid event " << getEventName() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool EventSubscriber::hasMoreFrames(zmq::socket_t &subscriber) {
+	int more = 0;
+	size_t moreSize = sizeof(more);
+	subscriber.getsockopt(ZMQ_RCVMORE, &more, &moreSize);
+	return more;
+}
+
+const uint8_t *EventSubscriber::getEventBuffer() const {
+	return static_cast<const uint8_t*>(mCurrentLane->eventData.data());
+}
+
+size_t EventSubscriber::getEventSize() const {
+	return mCurrentLane->eventData.size();
+}
+
+std::string EventSubscriber::getEventName() {
+	return std::string(
+			static_cast<const char*>(mCurrentLane->eventName.data()),
+			mCurrentLane->eventName.size());
+}
+
+bool EventSubscriber::prepareSubSynchronization(std::string address,
+		std::string port) {
+	return mSyncSubscriber.prepareSubSynchronization(address, port);
+}
+
+bool EventSubscriber::synchronizeSub() {
+	return mSyncSubscriber.synchronizeSub();
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTSUBSCRIBER_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTSUBSCRIBER_H_
+
+#include <string>
+#include <array>
+#include <stdint.h>
+#include <zmq.hpp>
+
+#include "communication/Subscriber.h"
+
+/** Checks a received event buffer, e.g., with a flatbuffers::Verifier **/
+typedef bool (*EventVerifier)(const uint8_t *buffer, size_t size);
+
+/** Receives the events of other models (ZMQ-SUB). The endpoint of a publisher
+ * (inproc, ipc or tcp) is requested from the configuration server.
+ * The synchronization with the simulation model is done by the subscriber of fraser.
+ *
+ * The received message is kept until the next event of its lane is received,
+ * so that the event can be accessed in place (no copy of the buffer or the
+ * name). A control event stays valid, while the pending events of the
+ * neighbours are received (see receivePendingEvent).
+ * Events are only verified (see setEventVerifier), if they are received from
+ * a publisher on another host (tcp). Links within a host (inproc, ipc) are
+ * trusted. Each lane connects to the two kinds of publishers with separate
+ * sockets, so the verification depends on the link of the received event.
+ *
+ * The events of the clock source (SimTimeChanged, End, SaveState, LoadState)
+ * are received on a separate high-priority lane (connectToControlPub), which
+ * is always read first. So a clock advance or a savepoint is never queued
+ * behind the flits of the neighbours. **/
+class EventSubscriber {
+public:
+	EventSubscriber(zmq::context_t &ctx);
+	virtual ~EventSubscriber();
+
+	void setOwnershipName(std::string name);
+
+	// Events of the neighbours (normal priority)
+	bool connectToPub(std::string endpoint);
+	void subscribeTo(std::string eventName);
+	// Events of the clock source (high priority)
+	bool connectToControlPub(std::string endpoint);
+	void subscribeToControl(std::string eventName);
+
+	void setEventVerifier(EventVerifier verifier) {
+		mEventVerifier = verifier;
+	}
+
+	/** Blocks until the next event is received. The events of a batch
+	 * (see EventPublisher::flushEvents) are returned one by one. **/
+	bool receiveEvent();
+	/** Checks whether an event of the neighbours was already received by the
+	 * socket (does not block) **/
+	bool hasPendingEvent();
+	/** Receives the next event of the neighbours, if it was already received
+	 * by the socket (does not block). Returns false if there is none or if
+	 * the event was dropped (see hasPendingEvent). **/
+	bool receivePendingEvent();
+	/** Buffer of the last received event (valid until the next event of its
+	 * lane is received) **/
+	const uint8_t *getEventBuffer() const;
+	size_t getEventSize() const;
+	/** Topic of the message of the last received event (the name of the
+	 * first event of a batch, see EventPublisher) **/
+	std::string getEventName();
+
+	// Synchronization
+	bool prepareSubSynchronization(std::string address, std::string port);
+	bool synchronizeSub();
+
+private:
+	// Sockets of a lane: Links within the host (trusted) and to other hosts
+	enum LinkType {
+		LocalLinks, RemoteLinks, NumOfLinkTypes
+	};
+
+	struct Lane {
+		Lane(zmq::context_t &ctx) :
+				subscribers { { zmq::socket_t(ctx, ZMQ_SUB), zmq::socket_t(ctx,
+						ZMQ_SUB) } } {
+		}
+
+		std::array<zmq::socket_t, NumOfLinkTypes> subscribers;
+		zmq::message_t eventName;
+		zmq::message_t eventData;
+		// Socket which received the current batch (further events follow)
+		// and the socket which has a new batch (see waitForLane)
+		LinkType batchLinks = LocalLinks;
+		bool moreEvents = false;
+		LinkType readyLinks = LocalLinks;
+	};
+
+	Lane mControlLane;
+	Lane mEventLane;
+	// Lane of the last received event
+	Lane *mCurrentLane;
+	Subscriber mSyncSubscriber;
+
+	bool connectLane(Lane &lane, std::string endpoint);
+	void subscribeLane(Lane &lane, const std::string &eventName);
+	/** Blocks until one of the lanes has an event (control lane first) **/
+	Lane &waitForLane();
+	/** Sets the socket of the next batch of the lane (local links first),
+	 * if one of the polled sockets of the lane has an event **/
+	bool setReadyLinks(Lane &lane, const zmq::pollitem_t *items);
+	bool receiveFromLane(Lane &lane);
+	bool hasMoreFrames(zmq::socket_t &subscriber);
+
+	EventVerifier mEventVerifier = nullptr;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTSUBSCRIBER_H_ */
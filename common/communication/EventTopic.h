@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTTOPIC_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTTOPIC_H_
+
+#include <string>
+#include <zmq.hpp>
+
+#include "LinkTopics.h"
+
+/** Topic of the events, which a model sends often (e.g., the flits on a link
+ * or its null messages). The frame of the topic is created once: Each sent
+ * event gets a copy of the frame, which shares its memory (reference count),
+ * so the topic is neither allocated nor copied per event. **/
+class EventTopic {
+public:
+	EventTopic() = default;
+
+	explicit EventTopic(const std::string &name) :
+			mName(name), mDestination(getTopicDestination(name)), mFrame(
+					name.data(), name.size()) {
+	}
+
+	EventTopic(const EventTopic &other) :
+			EventTopic(other.mName) {
+	}
+
+	EventTopic& operator=(const EventTopic &other) {
+		mName = other.mName;
+		mDestination = other.mDestination;
+		mFrame.rebuild(mName.data(), mName.size());
+		return *this;
+	}
+
+	/** Frame for a message, which refers to the frame of the topic **/
+	void copyFrameTo(zmq::message_t &frame) const {
+		frame.copy(&mFrame);
+	}
+
+	const std::string &getName() const {
+		return mName;
+	}
+
+	/** Prefix of the receiving model (see getTopicDestination) **/
+	const std::string &getDestination() const {
+		return mDestination;
+	}
+
+	bool empty() const {
+		return mName.empty();
+	}
+
+private:
+	std::string mName;
+	std::string mDestination;
+	// Only the reference count of the frame is changed by a copy
+	mutable zmq::message_t mFrame;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTTOPIC_H_ */
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTVERIFIER_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTVERIFIER_H_
+
+#include <stdint.h>
+#include <cstddef>
+
+#include "flatbuffers/flatbuffers.h"
+
+/** Event verifier for the subscriber (see EventSubscriber::setEventVerifier),
+ * which checks the buffer with the generated verify function of the schema:
+ *   mSubscriber.setEventVerifier(&verifyEventBuffer<event::VerifyEventBuffer>); **/
+template<bool (*Verify)(flatbuffers::Verifier&)>
+bool verifyEventBuffer(const uint8_t *buffer, size_t size) {
+	flatbuffers::Verifier verifier(buffer, size);
+	return Verify(verifier);
+}
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_EVENTVERIFIER_H_ */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_LINKTOPICS_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_LINKTOPICS_H_
+
+#include <string>
+
+/** Events on a link between two models (e.g., flits and credits) are addressed
+ * to the receiving model: The topic starts with its name, e.g., "router_1/North".
+ * A model subscribes only to its own prefix, so that each event is delivered
+ * exactly once, although a model is connected to the publishers of all
+ * models it depends on. Events of the simulation model and null messages
+ * are still published under their names (broadcast). **/
+inline std::string getLinkTopic(const std::string &destination,
+		const std::string &eventName) {
+	return destination + "/" + eventName;
+}
+
+/** Prefix of all events which are addressed to the model **/
+inline std::string getLinkPrefix(const std::string &modelName) {
+	return modelName + "/";
+}
+
+/** Destination of the events with the name: The prefix of the addressed model
+ * or the whole name of a broadcast event (e.g., "Null") **/
+inline std::string getTopicDestination(const std::string &eventName) {
+	auto separator = eventName.find('/');
+	if (separator == std::string::npos) {
+		return eventName;
+	}
+
+	return eventName.substr(0, separator + 1);
+}
+
+/** Requests to the future event service of a queue model: The request is an
+ * event of the type ScheduleEvent (or CancelEvent), which is addressed to the
+ * queue and carries the name of the requester (source). Its name, timestamp,
+ * repeat, period and data (Flit) describe the future event, which the queue
+ * releases as TimedEvent under this name when the simulation time reaches
+ * the timestamp. The name has the prefix of the requester, e.g.,
+ * getLinkTopic(mName, "Wakeup"), so the event is delivered to the requester
+ * only, and a model can only cancel its own events. CancelEvent removes all
+ * scheduled events with the name. Several requests of a cycle are sent as
+ * one batch (EventPublisher::queueEvent).
+ *
+ * In next-event mode the requester reports the time of its next scheduled
+ * event as its next activity: The queue may receive the request only after
+ * it reported its own next activity for the step. **/
+inline std::string getScheduleTopic(const std::string &queueName) {
+	return getLinkTopic(queueName, "ScheduleEvent");
+}
+
+inline std::string getCancelTopic(const std::string &queueName) {
+	return getLinkTopic(queueName, "CancelEvent");
+}
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_LINKTOPICS_H_ */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "StepCollector.h"
+#include "Endpoints.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+StepCollector::StepCollector(zmq::context_t &ctx) :
+		mPuller(ctx, ZMQ_PULL) {
+}
+
+StepCollector::~StepCollector() {
+	mPuller.close();
+}
+
+bool StepCollector::bindSocket(std::string endpoints) {
+	if (splitEndpoints(endpoints).empty()) {
+		std::cout << "No endpoints to bind the step collector" << std::endl;
+		return false;
+	}
+
+	for (auto endpoint : splitEndpoints(endpoints)) {
+		try {
+			mPuller.bind(endpoint);
+		} catch (std::exception &e) {
+			std::cout << "Could not bind step collector to " << endpoint
+					<< ": " << e.what() << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool StepCollector::collectStepReports(uint64_t numOfModels, long timeout,
+		uint64_t &nextActivityTime) {
+	zmq::pollitem_t items[] = { getPollItem() };
+
+	while (mNumOfStepReports < numOfModels) {
+		uint64_t reportedTime = NO_ACTIVITY;
+
+		if (!mPendingStepReports.empty()) {
+			reportedTime = receiveStepReport();
+		} else {
+			zmq::poll(items, 1, timeout);
+			if (!(items[0].revents & ZMQ_POLLIN)) {
+				return false;
+			}
+
+			// Savepoint reports are counted, wait for the step report
+			if (receiveReport(reportedTime) != ReportType::Step) {
+				continue;
+			}
+		}
+
+		mNextActivityTime = std::min(mNextActivityTime, reportedTime);
+		mNumOfStepReports++;
+	}
+
+	nextActivityTime = mNextActivityTime;
+	mNumOfStepReports = 0;
+	mNextActivityTime = NO_ACTIVITY;
+
+	return true;
+}
+
+uint64_t StepCollector::receiveStepReport() {
+	if (!mPendingStepReports.empty()) {
+		uint64_t reportedTime = mPendingStepReports.front();
+		mPendingStepReports.pop_front();
+		return reportedTime;
+	}
+
+	uint64_t reportedTime = NO_ACTIVITY;
+	while (receiveReport(reportedTime) != ReportType::Step) {
+		// Savepoint reports are counted, wait for the step report
+	}
+
+	return reportedTime;
+}
+
+ReportType StepCollector::receiveReport(uint64_t &nextActivityTime) {
+	zmq::message_t report;
+	mPuller.recv(&report);
+
+	return decodeReport(report, nextActivityTime);
+}
+
+void StepCollector::receivePendingReports() {
+	zmq::message_t report;
+	while (mPuller.recv(&report, ZMQ_DONTWAIT)) {
+		uint64_t reportedTime = NO_ACTIVITY;
+		if (decodeReport(report, reportedTime) == ReportType::Step) {
+			mPendingStepReports.push_back(reportedTime);
+		}
+	}
+}
+
+uint64_t StepCollector::getNumOfSavepointReports(uint64_t savepointTime) const {
+	auto reports = mSavepointReports.find(savepointTime);
+	if (reports == mSavepointReports.end()) {
+		return 0;
+	}
+
+	return reports->second;
+}
+
+void StepCollector::removeSavepointReports(uint64_t savepointTime) {
+	mSavepointReports.erase(savepointTime);
+}
+
+std::map<uint64_t, uint64_t> StepCollector::takeSavepointReports() {
+	std::map<uint64_t, uint64_t> savepointReports;
+	savepointReports.swap(mSavepointReports);
+	return savepointReports;
+}
+
+ReportType StepCollector::decodeReport(const zmq::message_t &report,
+		uint64_t &nextActivityTime) {
+	uint64_t data[2] = { NO_ACTIVITY, 0 };
+
+	// Savepoint report: savepoint time and number of models
+	if (report.size() == sizeof(data)) {
+		std::memcpy(data, report.data(), sizeof(data));
+		mSavepointReports[data[0]] += data[1];
+		return ReportType::Savepoint;
+	}
+
+	nextActivityTime = NO_ACTIVITY;
+	if (report.size() == sizeof(nextActivityTime)) {
+		std::memcpy(&nextActivityTime, report.data(), sizeof(nextActivityTime));
+	}
+
+	return ReportType::Step;
+}
+
+zmq::pollitem_t StepCollector::getPollItem() {
+	return {static_cast<void*>(mPuller), 0, ZMQ_POLLIN, 0};
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_STEPCOLLECTOR_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_STEPCOLLECTOR_H_
+
+#include <string>
+#include <map>
+#include <deque>
+#include <stdint.h>
+#include <zmq.hpp>
+
+#include "StepReporter.h"
+
+// Time (milliseconds) after which the waiting for step reports is
+// interrupted to check for a stop of the simulation
+const long STEP_REPORT_TIMEOUT = 100;
+
+enum class ReportType {
+	Step, Savepoint
+};
+
+/** Simulation model side of the step barrier (ZMQ-PULL).
+ * Collects the step reports of all models. Savepoint reports (asynchronous
+ * savepoints, see StepReporter::reportSavepointDone) are counted per savepoint. **/
+class StepCollector {
+public:
+	StepCollector(zmq::context_t &ctx);
+	virtual ~StepCollector();
+
+	/** Binds to all endpoints of the list (see Endpoints.h) **/
+	bool bindSocket(std::string endpoints);
+
+	/** Waits until the given number of models reported the finished step.
+	 * Returns false, if no report arrived within the timeout (milliseconds),
+	 * so that the caller can check for an interrupt: The reports which were
+	 * received so far are kept for the next call. Returns true with the
+	 * earliest next activity time of all reports in nextActivityTime. **/
+	bool collectStepReports(uint64_t numOfModels, long timeout,
+			uint64_t &nextActivityTime);
+
+	/** Blocks until one step report is received and returns its next activity time. **/
+	uint64_t receiveStepReport();
+
+	/** Blocks until one report is received. Returns the next activity time
+	 * of a step report in nextActivityTime. **/
+	ReportType receiveReport(uint64_t &nextActivityTime);
+
+	/** Receives all pending reports without blocking (e.g., savepoint
+	 * reports in real-time mode). Step reports are kept for receiveStepReport. **/
+	void receivePendingReports();
+
+	/** Number of models which reported the savepoint as durable **/
+	uint64_t getNumOfSavepointReports(uint64_t savepointTime) const;
+	void removeSavepointReports(uint64_t savepointTime);
+
+	/** Returns and removes the counted savepoint reports (savepoint time
+	 * and number of models), e.g., to forward them **/
+	std::map<uint64_t, uint64_t> takeSavepointReports();
+
+	/** Poll item to wait for step reports together with other sockets. **/
+	zmq::pollitem_t getPollItem();
+
+private:
+	ReportType decodeReport(const zmq::message_t &report,
+			uint64_t &nextActivityTime);
+
+	zmq::socket_t mPuller;
+
+	// Step reports which were received by receivePendingReports
+	std::deque<uint64_t> mPendingStepReports;
+	// Step reports of the time window which collectStepReports received
+	uint64_t mNumOfStepReports = 0;
+	uint64_t mNextActivityTime = NO_ACTIVITY;
+	std::map<uint64_t, uint64_t> mSavepointReports;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_STEPCOLLECTOR_H_ */
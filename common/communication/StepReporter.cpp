@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "StepReporter.h"
+
+#include <cstring>
+#include <iostream>
+
+StepReporter::StepReporter(zmq::context_t &ctx) :
+		mPusher(ctx, ZMQ_PUSH) {
+	int linger = 0;
+	mPusher.setsockopt(ZMQ_LINGER, &linger, sizeof(linger));
+}
+
+StepReporter::~StepReporter() {
+	mPusher.close();
+}
+
+bool StepReporter::connectToCollector(std::string endpoint) {
+	try {
+		mPusher.connect(endpoint);
+	} catch (std::exception &e) {
+		std::cout << "Could not connect to step collector: " << e.what()
+				<< std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void StepReporter::reportStepDone(uint64_t nextActivityTime) {
+	zmq::message_t report(sizeof(nextActivityTime));
+	std::memcpy(report.data(), &nextActivityTime, sizeof(nextActivityTime));
+	mPusher.send(report);
+}
+
+void StepReporter::reportSavepointDone(uint64_t savepointTime,
+		uint64_t numOfModels) {
+	// Savepoint reports are twice as long as step reports
+	uint64_t data[2] = { savepointTime, numOfModels };
+	zmq::message_t report(sizeof(data));
+	std::memcpy(report.data(), data, sizeof(data));
+	mPusher.send(report);
+}
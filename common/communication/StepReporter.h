@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_COMMUNICATION_STEPREPORTER_H_
+#define FRASER_TEMPLATE_COMMON_COMMUNICATION_STEPREPORTER_H_
+
+#include <string>
+#include <limits>
+#include <stdint.h>
+#include <zmq.hpp>
+
+// Reported by models, which have nothing to do until they receive an event
+const uint64_t NO_ACTIVITY = std::numeric_limits<uint64_t>::max();
+
+/** Model side of the step barrier (ZMQ-PUSH).
+ * After a model finished a simulation step, it reports the simulation time of
+ * its next activity (or NO_ACTIVITY) to the step collector of the simulation model.
+ * Asynchronous savepoints are reported on the same channel, when the state
+ * file of the model is durable (see StateWriter). **/
+class StepReporter {
+public:
+	StepReporter(zmq::context_t &ctx);
+	virtual ~StepReporter();
+
+	bool connectToCollector(std::string endpoint);
+	void reportStepDone(uint64_t nextActivityTime);
+	/** Reports the savepoint as durable for the given number of models
+	 * (more than one, if a clock relay forwards the reports of its host) **/
+	void reportSavepointDone(uint64_t savepointTime, uint64_t numOfModels = 1);
+
+private:
+	zmq::socket_t mPusher;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_COMMUNICATION_STEPREPORTER_H_ */
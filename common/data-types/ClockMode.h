@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_DATA_TYPES_CLOCKMODE_H_
+#define FRASER_TEMPLATE_COMMON_DATA_TYPES_CLOCKMODE_H_
+
+#include <string>
+
+/** Defines how the simulation model advances the global simulation time.
+ * The mode is set with the parameter 'clockMode' of the simulation model
+ * in the hosts-configuration file (hosts-configs/), so that every model
+ * can request it from the configuration server. **/
+enum class ClockMode {
+	// Wait the cycle time (SimTimeStep / SpeedFactor) between two steps
+	RealTime,
+	// Advance as soon as all models acknowledged the current step
+	AsFastAsPossible,
+	// Like AsFastAsPossible, but jump directly to the earliest
+	// next activity reported by the models (skip idle steps)
+	NextEvent,
+	// Like AsFastAsPossible, but within a granted time window the models are
+	// synchronized with their neighbours by null messages (link latencies)
+	Conservative
+};
+
+inline ClockMode toClockMode(std::string name) {
+	if (name == "afap") {
+		return ClockMode::AsFastAsPossible;
+	} else if (name == "next-event") {
+		return ClockMode::NextEvent;
+	} else if (name == "conservative") {
+		return ClockMode::Conservative;
+	}
+
+	// Default (also if the parameter is not defined)
+	return ClockMode::RealTime;
+}
+
+#endif /* FRASER_TEMPLATE_COMMON_DATA_TYPES_CLOCKMODE_H_ */
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "CheckpointArchive.h"
+#include "CheckpointStore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <unistd.h>
+#include <zlib.h>
+#include <boost/filesystem.hpp>
+#include <boost/uuid/detail/sha1.hpp>
+
+// Header of the chunk index: magic (8 bytes) and version (uint32_t),
+// followed by one entry per chunk (hash, offset, stored size and size).
+// The chunks of a file in the manifest have the same layout.
+#define CHUNK_INDEX_MAGIC "FRASERCI"
+#define CHUNK_INDEX_ENTRY_SIZE (sizeof(ChunkHash) + sizeof(uint64_t) \
+		+ 2 * sizeof(uint32_t))
+
+namespace {
+
+// Random values for the rolling hash of the chunking (splitmix64)
+struct GearTable {
+	uint64_t values[256];
+
+	GearTable() {
+		uint64_t state = 0;
+		for (auto &value : values) {
+			state += 0x9e3779b97f4a7c15ULL;
+			uint64_t z = state;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			value = z ^ (z >> 31);
+		}
+	}
+};
+
+const GearTable gearTable;
+
+ChunkHash getChunkHash(const char *data, uint32_t size) {
+	boost::uuids::detail::sha1 sha1;
+	sha1.process_bytes(data, size);
+
+	boost::uuids::detail::sha1::digest_type digest;
+	sha1.get_digest(digest);
+
+	ChunkHash hash;
+	static_assert(sizeof(digest) == sizeof(hash), "SHA-1 has 20 bytes");
+	std::memcpy(hash.data(), &digest, sizeof(hash));
+	return hash;
+}
+
+// Directory of the chunk store of a savepoint directory (its parent)
+std::string getStoreDirectory(const std::string &directory) {
+	boost::filesystem::path path(directory);
+	if (path.filename() == "." || path.filename().empty()) {
+		path = path.parent_path();
+	}
+
+	std::string storeDirectory = path.parent_path().string();
+	return storeDirectory.empty() ? "." : storeDirectory;
+}
+
+template<typename T>
+bool readValue(std::istream &is, T &value) {
+	return bool(is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+template<typename T>
+void writeValue(std::ostream &os, const T &value) {
+	os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool readLocation(std::istream &is, ChunkLocation &location) {
+	return readValue(is, location.offset) && readValue(is, location.storedSize)
+			&& readValue(is, location.size);
+}
+
+void writeLocation(std::ostream &os, const ChunkLocation &location) {
+	writeValue(os, location.offset);
+	writeValue(os, location.storedSize);
+	writeValue(os, location.size);
+}
+
+// Appends the (uncompressed) content of the chunk in the pack file to data
+bool readStoredChunk(std::ifstream &packReader, const ChunkLocation &location,
+		std::string &data) {
+	std::string stored(location.storedSize, '\0');
+	packReader.clear();
+	packReader.seekg(location.offset);
+	if (!packReader.read(&stored[0], location.storedSize)) {
+		return false;
+	}
+
+	if (location.storedSize == location.size) {
+		data.append(stored);
+		return true;
+	}
+
+	size_t position = data.size();
+	data.resize(position + location.size);
+	uLongf size = location.size;
+	return uncompress(reinterpret_cast<Bytef*>(&data[position]), &size,
+			reinterpret_cast<const Bytef*>(stored.data()), stored.size())
+			== Z_OK && size == location.size;
+}
+
+}
+
+size_t ChunkStore::HashFunction::operator()(const ChunkHash &hash) const {
+	size_t value;
+	std::memcpy(&value, hash.data(), sizeof(value));
+	return value;
+}
+
+bool ChunkStore::open(const std::string &directory, bool writable) {
+	mPackPath = (boost::filesystem::path(directory) / CHUNK_PACK_FILE_NAME)
+			.string();
+	mIndexPath = (boost::filesystem::path(directory) / CHUNK_INDEX_FILE_NAME)
+			.string();
+	mChunks.clear();
+	mNewChunks.clear();
+	this->readIndex();
+
+	if (writable) {
+		mPackWriter.open(mPackPath,
+				std::ios::binary | std::ios::out | std::ios::app);
+		if (!mPackWriter) {
+			std::cout << "Could not open chunk store " << mPackPath
+					<< std::endl;
+			return false;
+		}
+
+		// Chunks after the last index entry (e.g., of an aborted savepoint)
+		// are not referenced, new chunks are appended behind them
+		boost::system::error_code error;
+		mPackSize = boost::filesystem::file_size(mPackPath, error);
+		if (error) {
+			return false;
+		}
+	}
+
+	mPackReader.open(mPackPath, std::ios::binary);
+	return writable || bool(mPackReader);
+}
+
+void ChunkStore::readIndex() {
+	std::ifstream ifs(mIndexPath, std::ios::binary);
+
+	char magic[CHECKPOINT_ARCHIVE_MAGIC_SIZE] = { };
+	uint32_t version = 0;
+	ifs.read(magic, CHECKPOINT_ARCHIVE_MAGIC_SIZE);
+	if (!readValue(ifs, version)
+			|| std::memcmp(magic, CHUNK_INDEX_MAGIC,
+					CHECKPOINT_ARCHIVE_MAGIC_SIZE) != 0
+			|| version != CHUNK_INDEX_VERSION) {
+		return;
+	}
+
+	// An incomplete entry at the end is ignored
+	ChunkHash hash;
+	ChunkLocation location;
+	while (ifs.read(reinterpret_cast<char*>(hash.data()), hash.size())
+			&& readLocation(ifs, location)) {
+		mChunks[hash] = location;
+	}
+}
+
+ChunkLocation ChunkStore::addChunk(const char *data, uint32_t size,
+		bool compress, ChunkHash &hash) {
+	hash = getChunkHash(data, size);
+	auto chunk = mChunks.find(hash);
+	if (chunk != mChunks.end()) {
+		return chunk->second;
+	}
+
+	ChunkLocation location { mPackSize, size, size };
+
+	// The chunk is only stored compressed, if it gets smaller
+	std::string compressed;
+	if (compress) {
+		uLongf compressedSize = compressBound(size);
+		compressed.resize(compressedSize);
+		if (compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+				&compressedSize, reinterpret_cast<const Bytef*>(data), size,
+				Z_BEST_SPEED) == Z_OK && compressedSize < size) {
+			data = compressed.data();
+			location.storedSize = compressedSize;
+		}
+	}
+
+	mPackWriter.write(data, location.storedSize);
+	mPackSize += location.storedSize;
+
+	mChunks[hash] = location;
+	mNewChunks.push_back(std::make_pair(hash, location));
+	return location;
+}
+
+bool ChunkStore::readChunk(const ChunkHash &hash, std::string &data) {
+	auto chunk = mChunks.find(hash);
+	if (chunk == mChunks.end()) {
+		return false;
+	}
+
+	return readStoredChunk(mPackReader, chunk->second, data);
+}
+
+bool ChunkStore::sync() {
+	if (mNewChunks.empty()) {
+		return true;
+	}
+
+	// The index only refers to chunks, which are on the disk
+	mPackWriter.flush();
+	if (!mPackWriter || !syncFile(mPackPath)) {
+		return false;
+	}
+
+	bool newIndex = !boost::filesystem::exists(mIndexPath);
+	{
+		std::ofstream ofs(mIndexPath,
+				std::ios::binary | std::ios::out | std::ios::app);
+		if (newIndex) {
+			ofs.write(CHUNK_INDEX_MAGIC, CHECKPOINT_ARCHIVE_MAGIC_SIZE);
+			writeValue(ofs, uint32_t(CHUNK_INDEX_VERSION));
+		}
+
+		for (auto &chunk : mNewChunks) {
+			ofs.write(reinterpret_cast<const char*>(chunk.first.data()),
+					chunk.first.size());
+			writeLocation(ofs, chunk.second);
+		}
+
+		if (!ofs) {
+			return false;
+		}
+	}
+	mNewChunks.clear();
+
+	return syncFile(mIndexPath);
+}
+
+std::vector<uint32_t> getChunkBoundaries(const std::string &data) {
+	std::vector<uint32_t> boundaries;
+
+	uint64_t hash = 0;
+	uint32_t chunkStart = 0;
+	for (uint32_t position = 0; position < data.size(); position++) {
+		hash = (hash << 1)
+				+ gearTable.values[static_cast<uint8_t>(data[position])];
+
+		uint32_t chunkSize = position + 1 - chunkStart;
+		if ((chunkSize >= CHUNK_MIN_SIZE && (hash & CHUNK_HASH_MASK) == 0)
+				|| chunkSize >= CHUNK_MAX_SIZE) {
+			boundaries.push_back(position + 1);
+			chunkStart = position + 1;
+			hash = 0;
+		}
+	}
+
+	if (chunkStart < data.size()) {
+		boundaries.push_back(data.size());
+	}
+	return boundaries;
+}
+
+bool archiveCheckpoint(const std::string &directory, bool compress) {
+	namespace fs = boost::filesystem;
+
+	std::vector<std::string> files = getStateFiles(directory);
+	if (files.empty()) {
+		return false;
+	}
+
+	ChunkStore store;
+	if (!store.open(getStoreDirectory(directory), true)) {
+		return false;
+	}
+
+	std::string manifestPath = (fs::path(directory)
+			/ CHECKPOINT_ARCHIVE_FILE_NAME).string();
+	std::string tempPath = manifestPath + ".tmp";
+	{
+		std::ofstream ofs(tempPath, std::ios::binary);
+		ofs.write(CHECKPOINT_ARCHIVE_MAGIC, CHECKPOINT_ARCHIVE_MAGIC_SIZE);
+		writeValue(ofs, uint32_t(CHECKPOINT_ARCHIVE_VERSION));
+		writeValue(ofs, uint32_t(files.size()));
+
+		for (auto &name : files) {
+			std::ifstream ifs((fs::path(directory) / name).string(),
+					std::ios::binary);
+			std::string data((std::istreambuf_iterator<char>(ifs)),
+					std::istreambuf_iterator<char>());
+			std::vector<uint32_t> boundaries = getChunkBoundaries(data);
+
+			writeValue(ofs, uint32_t(name.size()));
+			ofs.write(name.data(), name.size());
+			writeValue(ofs, uint64_t(data.size()));
+			writeValue(ofs, uint32_t(boundaries.size()));
+
+			uint32_t chunkStart = 0;
+			for (auto chunkEnd : boundaries) {
+				ChunkHash hash;
+				ChunkLocation location = store.addChunk(
+						data.data() + chunkStart, chunkEnd - chunkStart,
+						compress, hash);
+				ofs.write(reinterpret_cast<const char*>(hash.data()),
+						hash.size());
+				writeLocation(ofs, location);
+				chunkStart = chunkEnd;
+			}
+		}
+
+		if (!ofs) {
+			std::cout << "Could not write checkpoint archive " << manifestPath
+					<< std::endl;
+			return false;
+		}
+	}
+
+	// The state files are only removed, when the chunks and the manifest
+	// are on the disk
+	if (!store.sync() || !syncFile(tempPath)) {
+		return false;
+	}
+
+	boost::system::error_code error;
+	fs::rename(tempPath, manifestPath, error);
+	if (error) {
+		return false;
+	}
+
+	for (auto &name : files) {
+		fs::remove(fs::path(directory) / name, error);
+	}
+
+	return true;
+}
+
+bool readArchivedFile(const std::string &filePath, std::string &data) {
+	namespace fs = boost::filesystem;
+
+	if (::access(filePath.c_str(), F_OK) == 0) {
+		return false;
+	}
+
+	fs::path path(filePath);
+	std::string directory = path.parent_path().string();
+	std::string fileName = path.filename().string();
+
+	std::ifstream ifs(
+			(fs::path(directory) / CHECKPOINT_ARCHIVE_FILE_NAME).string(),
+			std::ios::binary);
+	char magic[CHECKPOINT_ARCHIVE_MAGIC_SIZE] = { };
+	uint32_t version = 0;
+	uint32_t numOfFiles = 0;
+	ifs.read(magic, CHECKPOINT_ARCHIVE_MAGIC_SIZE);
+	if (!readValue(ifs, version) || !readValue(ifs, numOfFiles)
+			|| std::memcmp(magic, CHECKPOINT_ARCHIVE_MAGIC,
+					CHECKPOINT_ARCHIVE_MAGIC_SIZE) != 0
+			|| version != CHECKPOINT_ARCHIVE_VERSION) {
+		return false;
+	}
+
+	for (uint32_t file = 0; file < numOfFiles; file++) {
+		uint32_t nameSize = 0;
+		uint64_t size = 0;
+		uint32_t numOfChunks = 0;
+		if (!readValue(ifs, nameSize)) {
+			return false;
+		}
+		std::string name(nameSize, '\0');
+		ifs.read(&name[0], nameSize);
+		if (!readValue(ifs, size) || !readValue(ifs, numOfChunks)) {
+			return false;
+		}
+
+		if (name != fileName) {
+			ifs.seekg(numOfChunks * CHUNK_INDEX_ENTRY_SIZE, std::ios::cur);
+			continue;
+		}
+
+		// The index of the store is not needed: The manifest holds the
+		// locations of the chunks in the pack file
+		std::ifstream packReader(
+				(fs::path(getStoreDirectory(directory)) / CHUNK_PACK_FILE_NAME)
+						.string(), std::ios::binary);
+		if (!packReader) {
+			return false;
+		}
+
+		data.clear();
+		data.reserve(size);
+		for (uint32_t chunk = 0; chunk < numOfChunks; chunk++) {
+			ChunkHash hash;
+			ChunkLocation location;
+			if (!ifs.read(reinterpret_cast<char*>(hash.data()), hash.size())
+					|| !readLocation(ifs, location)
+					|| !readStoredChunk(packReader, location, data)) {
+				std::cout << "Missing chunk of the archived file " << filePath
+						<< std::endl;
+				return false;
+			}
+		}
+		return data.size() == size;
+	}
+
+	return false;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_PERSISTENCE_CHECKPOINTARCHIVE_H_
+#define FRASER_TEMPLATE_COMMON_PERSISTENCE_CHECKPOINTARCHIVE_H_
+
+#include <string>
+#include <vector>
+#include <array>
+#include <fstream>
+#include <unordered_map>
+#include <stdint.h>
+
+// Manifest of an archived savepoint: magic (8 bytes), version (uint32_t) and
+// number of files (uint32_t), followed by the name, size and chunks of each
+// file. A chunk is stored with its hash and its location in the pack file,
+// so a model reads its file without the index of the store.
+#define CHECKPOINT_ARCHIVE_MAGIC "FRASERCA"
+#define CHECKPOINT_ARCHIVE_MAGIC_SIZE 8
+#define CHECKPOINT_ARCHIVE_VERSION 2
+#define CHUNK_INDEX_VERSION 1
+#define CHECKPOINT_ARCHIVE_FILE_NAME "checkpoint.fca"
+// Chunks of all savepoints of a directory (e.g., ../savepoints/): The chunks
+// are appended to the pack file, the index holds the location of each chunk
+#define CHUNK_PACK_FILE_NAME "chunks.pack"
+#define CHUNK_INDEX_FILE_NAME "chunks.idx"
+
+// Content-defined chunking: A chunk ends, where the rolling hash of the last
+// bytes matches the mask (about every 512 bytes), within the size limits.
+// Equal parts of the state files are split into equal chunks, even if the
+// parts are shifted (e.g., by an address of another length).
+#define CHUNK_MIN_SIZE 128
+#define CHUNK_MAX_SIZE 4096
+#define CHUNK_HASH_MASK 0xff80000000000000ULL
+
+// SHA-1 of the (uncompressed) content of a chunk
+typedef std::array<uint8_t, 20> ChunkHash;
+
+struct ChunkLocation {
+	uint64_t offset;
+	// Stored size is smaller than the size, if the chunk is compressed
+	uint32_t storedSize;
+	uint32_t size;
+};
+
+/** Content-addressed store of chunks, which is shared by all savepoints of
+ * a directory. Each chunk is stored once (optionally compressed with zlib).
+ * The simulation model is the only writer, models read their files. **/
+class ChunkStore {
+public:
+	/** Reads the index of the store in the directory (created for writing) **/
+	bool open(const std::string &directory, bool writable);
+
+	/** Stores the chunk, if its content is not stored yet. Returns its
+	 * location in the pack file. **/
+	ChunkLocation addChunk(const char *data, uint32_t size, bool compress,
+			ChunkHash &hash);
+	/** Appends the content of the chunk to data **/
+	bool readChunk(const ChunkHash &hash, std::string &data);
+
+	/** Writes the new chunks and afterwards their index to the disk **/
+	bool sync();
+
+	uint64_t getNumOfChunks() const {
+		return mChunks.size();
+	}
+
+private:
+	struct HashFunction {
+		size_t operator()(const ChunkHash &hash) const;
+	};
+
+	void readIndex();
+
+	std::string mPackPath;
+	std::string mIndexPath;
+	std::unordered_map<ChunkHash, ChunkLocation, HashFunction> mChunks;
+
+	std::ifstream mPackReader;
+	std::ofstream mPackWriter;
+	uint64_t mPackSize = 0;
+	// Index entries of the chunks, which are not synced yet
+	std::vector<std::pair<ChunkHash, ChunkLocation>> mNewChunks;
+};
+
+/** Ends of the content-defined chunks of the data **/
+std::vector<uint32_t> getChunkBoundaries(const std::string &data);
+
+/** Stores the state files (*.config) of the directory as chunks in the store
+ * of its parent directory and writes the manifest of the directory. The state
+ * files are removed afterwards. Returns false, if no manifest was written. **/
+bool archiveCheckpoint(const std::string &directory, bool compress);
+
+/** Reads an archived state file with the chunk locations of the manifest
+ * from the pack file. Returns false, if the file is not archived (or exists,
+ * see openCheckpointSection). **/
+bool readArchivedFile(const std::string &filePath, std::string &data);
+
+#endif /* FRASER_TEMPLATE_COMMON_PERSISTENCE_CHECKPOINTARCHIVE_H_ */
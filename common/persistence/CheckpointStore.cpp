@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "CheckpointStore.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <boost/filesystem.hpp>
+
+MappedCheckpoint::~MappedCheckpoint() {
+	this->close();
+}
+
+bool MappedCheckpoint::open(const std::string &filePath) {
+	this->close();
+
+	int fd = ::open(filePath.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (::fstat(fd, &fileStatus) != 0 || fileStatus.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after the file is closed
+	void *data = ::mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_SHARED, fd,
+			0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+	mData = static_cast<const char*>(data);
+	mSize = fileStatus.st_size;
+
+	if (!this->readIndex()) {
+		std::cout << "Invalid checkpoint container " << filePath << std::endl;
+		this->close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedCheckpoint::close() {
+	if (mData != nullptr) {
+		::munmap(const_cast<char*>(mData), mSize);
+	}
+
+	mData = nullptr;
+	mSize = 0;
+	mSections.clear();
+}
+
+bool MappedCheckpoint::findSection(const std::string &name,
+		const char *&data, uint64_t &size) const {
+	auto section = std::lower_bound(mSections.begin(), mSections.end(), name,
+			[](const Section &section, const std::string &name) {
+				return section.name < name;
+			});
+	if (section == mSections.end() || section->name != name) {
+		return false;
+	}
+
+	data = mData + section->offset;
+	size = section->size;
+	return true;
+}
+
+bool MappedCheckpoint::readIndex() {
+	uint64_t position = 0;
+	auto read = [&](void *value, uint64_t size) {
+		if (position + size > mSize) {
+			return false;
+		}
+		std::memcpy(value, mData + position, size);
+		position += size;
+		return true;
+	};
+
+	char magic[CHECKPOINT_MAGIC_SIZE];
+	uint32_t version = 0;
+	uint32_t numOfSections = 0;
+	if (!read(magic, CHECKPOINT_MAGIC_SIZE)
+			|| std::memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) != 0
+			|| !read(&version, sizeof(version))
+			|| version != CHECKPOINT_VERSION
+			|| !read(&numOfSections, sizeof(numOfSections))) {
+		return false;
+	}
+
+	mSections.resize(numOfSections);
+	for (auto &section : mSections) {
+		uint32_t nameSize = 0;
+		if (!read(&section.offset, sizeof(section.offset))
+				|| !read(&section.size, sizeof(section.size))
+				|| !read(&nameSize, sizeof(nameSize))
+				|| position + nameSize > mSize) {
+			return false;
+		}
+		section.name.assign(mData + position, nameSize);
+		position += nameSize;
+
+		if (section.offset > mSize || section.size > mSize - section.offset) {
+			return false;
+		}
+	}
+
+	// The index is written in the order of the names
+	return std::is_sorted(mSections.begin(), mSections.end(),
+			[](const Section &a, const Section &b) {
+				return a.name < b.name;
+			});
+}
+
+bool openCheckpointSection(const std::string &filePath,
+		MappedCheckpoint &checkpoint, const char *&data, uint64_t &size) {
+	if (::access(filePath.c_str(), F_OK) == 0) {
+		return false;
+	}
+
+	size_t separator = filePath.find_last_of('/');
+	std::string directory =
+			(separator == std::string::npos) ?
+					"" : filePath.substr(0, separator + 1);
+	std::string name =
+			(separator == std::string::npos) ?
+					filePath : filePath.substr(separator + 1);
+
+	return checkpoint.open(directory + CHECKPOINT_FILE_NAME)
+			&& checkpoint.findSection(name, data, size);
+}
+
+std::vector<std::string> getStateFiles(const std::string &directory) {
+	namespace fs = boost::filesystem;
+
+	boost::system::error_code error;
+	std::vector<std::string> files;
+	for (fs::directory_iterator entry(directory, error), end;
+			!error && entry != end; entry.increment(error)) {
+		if (fs::is_regular_file(entry->path())
+				&& entry->path().extension() == ".config") {
+			files.push_back(entry->path().filename().string());
+		}
+	}
+
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+bool packCheckpoint(const std::string &directory) {
+	namespace fs = boost::filesystem;
+
+	boost::system::error_code error;
+	std::vector<fs::path> files;
+	for (auto &name : getStateFiles(directory)) {
+		files.push_back(fs::path(directory) / name);
+	}
+	if (files.empty()) {
+		return false;
+	}
+
+	// Index: offset, size and name of each section
+	uint64_t offset = CHECKPOINT_MAGIC_SIZE + 2 * sizeof(uint32_t);
+	for (auto &file : files) {
+		offset += 2 * sizeof(uint64_t) + sizeof(uint32_t)
+				+ file.filename().string().size();
+	}
+
+	std::string containerPath = (fs::path(directory) / CHECKPOINT_FILE_NAME)
+			.string();
+	std::string tempPath = containerPath + ".tmp";
+	{
+		std::ofstream ofs(tempPath, std::ios::binary);
+		uint32_t version = CHECKPOINT_VERSION;
+		uint32_t numOfSections = files.size();
+		ofs.write(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE);
+		ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		ofs.write(reinterpret_cast<const char*>(&numOfSections),
+				sizeof(numOfSections));
+
+		std::vector<uint64_t> offsets;
+		std::vector<uint64_t> sizes;
+		for (auto &file : files) {
+			offset = (offset + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT
+					* CHECKPOINT_ALIGNMENT;
+			uint64_t size = fs::file_size(file, error);
+			std::string name = file.filename().string();
+			uint32_t nameSize = name.size();
+			if (error) {
+				return false;
+			}
+
+			ofs.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+			ofs.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			ofs.write(reinterpret_cast<const char*>(&nameSize),
+					sizeof(nameSize));
+			ofs.write(name.data(), nameSize);
+
+			offsets.push_back(offset);
+			sizes.push_back(size);
+			offset += size;
+		}
+
+		for (size_t i = 0; i < files.size(); i++) {
+			if (sizes[i] == 0) {
+				continue;
+			}
+
+			// Padding up to the aligned section
+			ofs.seekp(offsets[i]);
+			std::ifstream ifs(files[i].string(), std::ios::binary);
+			ofs << ifs.rdbuf();
+		}
+
+		if (!ofs) {
+			std::cout << "Could not write checkpoint container "
+					<< containerPath << std::endl;
+			return false;
+		}
+	}
+
+	// The state files are only removed, when the container is complete
+	if (!syncFile(tempPath)) {
+		return false;
+	}
+	fs::rename(tempPath, containerPath, error);
+	if (error) {
+		return false;
+	}
+
+	for (auto &file : files) {
+		fs::remove(file, error);
+	}
+
+	return true;
+}
+
+bool syncFile(const std::string &filePath) {
+	int fd = ::open(filePath.c_str(), O_RDONLY);
+	if (fd < 0 || ::fsync(fd) != 0) {
+		std::cout << "Could not sync file " << filePath << std::endl;
+		if (fd >= 0) {
+			::close(fd);
+		}
+		return false;
+	}
+
+	::close(fd);
+	return true;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_PERSISTENCE_CHECKPOINTSTORE_H_
+#define FRASER_TEMPLATE_COMMON_PERSISTENCE_CHECKPOINTSTORE_H_
+
+#include <string>
+#include <vector>
+#include <streambuf>
+#include <stdint.h>
+
+// Header of a checkpoint container: magic (8 bytes), version (uint32_t) and
+// number of sections (uint32_t), followed by the index of the sections
+// (offset, size and name of each section, sorted by name) and their data
+#define CHECKPOINT_MAGIC "FRASERCP"
+#define CHECKPOINT_MAGIC_SIZE 8
+#define CHECKPOINT_VERSION 1
+// The data of each section starts at a multiple of the alignment
+#define CHECKPOINT_ALIGNMENT 64
+// Container in the directory of a savepoint (or configuration)
+#define CHECKPOINT_FILE_NAME "checkpoint.fcp"
+
+/** Defines how the state files of a savepoint are kept. The store is set
+ * with the parameter 'checkpointStore' of the simulation model. **/
+enum class CheckpointStore {
+	// One state file per model
+	Files,
+	// The state files on the host of the simulation model are packed into
+	// one container per savepoint, which the models map into memory
+	Mapped,
+	// The state files on the host of the simulation model are split into
+	// chunks, which are stored once for all savepoints (see CheckpointArchive)
+	Archive
+};
+
+inline CheckpointStore toCheckpointStore(std::string name) {
+	if (name == "mapped") {
+		return CheckpointStore::Mapped;
+	} else if (name == "archive") {
+		return CheckpointStore::Archive;
+	}
+
+	// Default (also if the parameter is not defined)
+	return CheckpointStore::Files;
+}
+
+/** Read-only memory mapping of a checkpoint container. The sections of the
+ * models are accessed directly in the mapped memory (see MemoryBuffer). **/
+class MappedCheckpoint {
+public:
+	MappedCheckpoint() = default;
+	MappedCheckpoint(const MappedCheckpoint&) = delete;
+	MappedCheckpoint& operator=(const MappedCheckpoint&) = delete;
+	virtual ~MappedCheckpoint();
+
+	/** Returns false, if the file does not exist or is no valid container **/
+	bool open(const std::string &filePath);
+	void close();
+
+	/** Data of the section with the given name (e.g., "router_0.config") **/
+	bool findSection(const std::string &name, const char *&data,
+			uint64_t &size) const;
+
+private:
+	struct Section {
+		std::string name;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	bool readIndex();
+
+	const char *mData = nullptr;
+	uint64_t mSize = 0;
+	std::vector<Section> mSections;
+};
+
+/** Stream buffer on memory, which is not copied (e.g., a mapped section) **/
+class MemoryBuffer: public std::streambuf {
+public:
+	MemoryBuffer(const char *data, uint64_t size) {
+		char *begin = const_cast<char*>(data);
+		this->setg(begin, begin, begin + size);
+	}
+
+protected:
+	virtual pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+			std::ios_base::openmode) override {
+		char *position = this->gptr();
+		if (direction == std::ios_base::beg) {
+			position = this->eback();
+		} else if (direction == std::ios_base::end) {
+			position = this->egptr();
+		}
+		position += offset;
+
+		if (position < this->eback() || position > this->egptr()) {
+			return pos_type(off_type(-1));
+		}
+		this->setg(this->eback(), position, this->egptr());
+		return pos_type(position - this->eback());
+	}
+
+	virtual pos_type seekpos(pos_type position, std::ios_base::openmode mode)
+			override {
+		return this->seekoff(off_type(position), std::ios_base::beg, mode);
+	}
+};
+
+/** Opens the container of the directory of the state file and looks up the
+ * section of the file. Returns false, if the file is not packed or if the
+ * file exists (written after the container, e.g., the same savepoint was
+ * taken again). **/
+bool openCheckpointSection(const std::string &filePath,
+		MappedCheckpoint &checkpoint, const char *&data, uint64_t &size);
+
+/** State files (*.config) of the directory, sorted by name **/
+std::vector<std::string> getStateFiles(const std::string &directory);
+
+/** Packs the state files (*.config) of the directory into its container and
+ * removes them afterwards. Returns false, if no container was written. **/
+bool packCheckpoint(const std::string &directory);
+
+/** Writes the data of the file to the disk (fsync) **/
+bool syncFile(const std::string &filePath);
+
+#endif /* FRASER_TEMPLATE_COMMON_PERSISTENCE_CHECKPOINTSTORE_H_ */
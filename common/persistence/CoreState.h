@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_PERSISTENCE_CORESTATE_H_
+#define FRASER_TEMPLATE_COMMON_PERSISTENCE_CORESTATE_H_
+
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+#include <string>
+#include <boost/serialization/nvp.hpp>
+
+/** The cores of the models (router, packet generator and sink) are part of a
+ * separate repository and do not necessarily provide access to their
+ * internal state. A core with a public serialize() is stored completely with
+ * the state of its adapter. Otherwise the adapter restores the state which
+ * it observed at the interface of the core (e.g., the flits in the FIFOs),
+ * if this is the complete state of the core.
+ *
+ * Whether the state of the core was stored is part of the state file
+ * ("HasCoreState"). A file with the state of a core can only be loaded by a
+ * build in which the core is serializable. **/
+
+/** Thrown while a state is loaded, if the state of a core is missing and
+ * cannot be restored exactly. The model does not continue with a state,
+ * which differs from the savepoint. **/
+class MissingCoreState: public std::runtime_error {
+public:
+	explicit MissingCoreState(const std::string &what) :
+			std::runtime_error(what) {
+	}
+};
+
+template<typename Archive, typename Core, typename = void>
+struct HasSerialize: std::false_type {
+};
+
+template<typename Archive, typename Core>
+struct HasSerialize<Archive, Core,
+		decltype(std::declval<Core&>().serialize(std::declval<Archive&>(), 0u), void())> : std::true_type {
+};
+
+template<typename Archive, typename Core>
+void serializeCore(Archive &archive, const char *name, Core &core,
+		std::true_type) {
+	archive & boost::serialization::make_nvp(name, core);
+}
+
+template<typename Archive, typename Core>
+void serializeCore(Archive&, const char *name, Core&, std::false_type) {
+	throw MissingCoreState(
+			std::string(name) + " is not serializable in this build");
+}
+
+/** Stores or restores the state of the core, if it is serializable. Returns
+ * true, if the state of the core is (or was) stored in the archive. **/
+template<typename Archive, typename Core>
+bool archiveCoreState(Archive &archive, const char *name, Core &core) {
+	bool hasCoreState = HasSerialize<Archive, Core>::value;
+	archive & boost::serialization::make_nvp("HasCoreState", hasCoreState);
+
+	if (hasCoreState) {
+		serializeCore(archive, name, core, HasSerialize<Archive, Core>());
+	}
+	return hasCoreState;
+}
+
+#endif /* FRASER_TEMPLATE_COMMON_PERSISTENCE_CORESTATE_H_ */
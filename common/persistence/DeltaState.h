@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_PERSISTENCE_DELTASTATE_H_
+#define FRASER_TEMPLATE_COMMON_PERSISTENCE_DELTASTATE_H_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <stdint.h>
+
+// Header of a delta state file: magic (8 bytes), version (uint32_t),
+// block size (uint32_t), state size (uint64_t) and the path of the base file
+#define DELTA_STATE_MAGIC "FRASERDL"
+#define DELTA_STATE_MAGIC_SIZE 8
+// The state is compared in blocks of this size (bytes)
+#define DELTA_STATE_BLOCK_SIZE 64
+
+/** Last full (binary) state file of a model, to which the following delta
+ * savepoints refer. Each model owns its base (see StateFormat::Delta). **/
+struct DeltaBase {
+	std::string filePath;
+	// Serialized state of the base file (without header)
+	std::string image;
+};
+
+/** Blocks of the state, which differ from the base (the state can be larger
+ * or smaller than the base) **/
+inline std::vector<uint64_t> getChangedBlocks(const std::string &baseImage,
+		const std::string &image) {
+	std::vector<uint64_t> changedBlocks;
+
+	for (uint64_t offset = 0; offset < image.size(); offset +=
+			DELTA_STATE_BLOCK_SIZE) {
+		uint64_t size = std::min<uint64_t>(DELTA_STATE_BLOCK_SIZE,
+				image.size() - offset);
+		if (offset + size > baseImage.size()
+				|| std::memcmp(image.data() + offset, baseImage.data() + offset,
+						size) != 0) {
+			changedBlocks.push_back(offset / DELTA_STATE_BLOCK_SIZE);
+		}
+	}
+
+	return changedBlocks;
+}
+
+/** Writes the changed blocks of the state and the path of the base file **/
+inline void writeDeltaState(const std::string &filePath,
+		const DeltaBase &base, const std::string &image,
+		const std::vector<uint64_t> &changedBlocks, uint32_t version) {
+	std::ofstream ofs(filePath, std::ios::binary);
+
+	uint32_t blockSize = DELTA_STATE_BLOCK_SIZE;
+	uint64_t stateSize = image.size();
+	uint32_t pathSize = base.filePath.size();
+	uint64_t numOfBlocks = changedBlocks.size();
+
+	ofs.write(DELTA_STATE_MAGIC, DELTA_STATE_MAGIC_SIZE);
+	ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	ofs.write(reinterpret_cast<const char*>(&blockSize), sizeof(blockSize));
+	ofs.write(reinterpret_cast<const char*>(&stateSize), sizeof(stateSize));
+	ofs.write(reinterpret_cast<const char*>(&pathSize), sizeof(pathSize));
+	ofs.write(base.filePath.data(), pathSize);
+	ofs.write(reinterpret_cast<const char*>(&numOfBlocks), sizeof(numOfBlocks));
+
+	for (auto block : changedBlocks) {
+		uint64_t offset = block * DELTA_STATE_BLOCK_SIZE;
+		uint64_t size = std::min<uint64_t>(DELTA_STATE_BLOCK_SIZE,
+				image.size() - offset);
+		ofs.write(reinterpret_cast<const char*>(&block), sizeof(block));
+		ofs.write(image.data() + offset, size);
+	}
+}
+
+/** Rebuilds the state from the base file (read with readBase) and the
+ * changed blocks. The stream is positioned after the magic and version.
+ * Returns false, if the file or its base is invalid. **/
+template<typename ReadBase>
+bool readDeltaState(std::istream &is, std::string &image,
+		ReadBase readBase) {
+	uint32_t blockSize = 0;
+	uint64_t stateSize = 0;
+	uint32_t pathSize = 0;
+	is.read(reinterpret_cast<char*>(&blockSize), sizeof(blockSize));
+	is.read(reinterpret_cast<char*>(&stateSize), sizeof(stateSize));
+	is.read(reinterpret_cast<char*>(&pathSize), sizeof(pathSize));
+
+	std::string basePath(pathSize, '\0');
+	is.read(&basePath[0], pathSize);
+	if (!is || blockSize == 0 || !readBase(basePath, image)) {
+		return false;
+	}
+	image.resize(stateSize);
+
+	uint64_t numOfBlocks = 0;
+	is.read(reinterpret_cast<char*>(&numOfBlocks), sizeof(numOfBlocks));
+	for (uint64_t i = 0; i < numOfBlocks && is; i++) {
+		uint64_t block = 0;
+		is.read(reinterpret_cast<char*>(&block), sizeof(block));
+
+		uint64_t offset = block * blockSize;
+		if (offset >= stateSize) {
+			return false;
+		}
+		uint64_t size = std::min<uint64_t>(blockSize, stateSize - offset);
+		is.read(&image[offset], size);
+	}
+
+	return bool(is);
+}
+
+#endif /* FRASER_TEMPLATE_COMMON_PERSISTENCE_DELTASTATE_H_ */
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_PERSISTENCE_STATEARCHIVE_H_
+#define FRASER_TEMPLATE_COMMON_PERSISTENCE_STATEARCHIVE_H_
+
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <stdint.h>
+#include <boost/serialization/nvp.hpp>
+#include <boost/archive/archive_exception.hpp>
+#include <boost/archive/xml_oarchive.hpp>
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+
+#include "common/persistence/DeltaState.h"
+#include "common/persistence/CheckpointStore.h"
+#include "common/persistence/CheckpointArchive.h"
+
+// Header of a binary state file: magic (8 bytes) and version (uint32_t)
+#define STATE_ARCHIVE_MAGIC "FRASERST"
+#define STATE_ARCHIVE_MAGIC_SIZE 8
+#define STATE_ARCHIVE_VERSION 1
+
+/** Format of the state files (savepoints), which is set with the parameter
+ * 'stateFormat' of the simulation model in the hosts-configuration file:
+ * xml (default, readable and editable), binary (fast, for long runs) or
+ * delta (binary, but only the blocks of the state which changed since the
+ * last full savepoint of the model are written).
+ * The format of a file is detected when it is loaded, so the default
+ * configurations (XML) can still be loaded in a binary run. **/
+enum class StateFormat {
+	Xml, Binary, Delta
+};
+
+inline StateFormat toStateFormat(std::string name) {
+	if (name == "binary") {
+		return StateFormat::Binary;
+	} else if (name == "delta") {
+		return StateFormat::Delta;
+	}
+
+	// Default (also if the parameter is not defined)
+	return StateFormat::Xml;
+}
+
+/** Serialized state (binary archive without header) **/
+template<typename T>
+std::string getStateImage(const char *name, T &object) {
+	std::ostringstream oss(std::ios::binary);
+	{
+		boost::archive::binary_oarchive oa(oss, boost::archive::no_header);
+		oa << boost::serialization::make_nvp(name, object);
+	}
+	return oss.str();
+}
+
+inline void writeStateImage(const std::string &filePath,
+		const std::string &image) {
+	std::ofstream ofs(filePath, std::ios::binary);
+	uint32_t version = STATE_ARCHIVE_VERSION;
+	ofs.write(STATE_ARCHIVE_MAGIC, STATE_ARCHIVE_MAGIC_SIZE);
+	ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	ofs.write(image.data(), image.size());
+}
+
+/** Reads the state of a full binary state file from the stream **/
+inline bool readStateImageFrom(std::istream &is, std::string &image) {
+	char magic[STATE_ARCHIVE_MAGIC_SIZE] = { };
+	uint32_t version = 0;
+	is.read(magic, STATE_ARCHIVE_MAGIC_SIZE);
+	is.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (!is
+			|| std::memcmp(magic, STATE_ARCHIVE_MAGIC, STATE_ARCHIVE_MAGIC_SIZE)
+					!= 0 || version != STATE_ARCHIVE_VERSION) {
+		return false;
+	}
+
+	image.assign(std::istreambuf_iterator<char>(is),
+			std::istreambuf_iterator<char>());
+	return true;
+}
+
+/** Calls read with a stream of the state file. The file can be packed into
+ * the checkpoint container (mapped) or the archive of its directory. **/
+template<typename Read>
+auto readStateFile(const std::string &filePath, Read read) {
+	MappedCheckpoint checkpoint;
+	const char *data = nullptr;
+	uint64_t size = 0;
+	if (openCheckpointSection(filePath, checkpoint, data, size)) {
+		MemoryBuffer buffer(data, size);
+		std::istream is(&buffer);
+		return read(is);
+	}
+
+	std::string archivedData;
+	if (readArchivedFile(filePath, archivedData)) {
+		MemoryBuffer buffer(archivedData.data(), archivedData.size());
+		std::istream is(&buffer);
+		return read(is);
+	}
+
+	std::ifstream ifs(filePath, std::ios::binary);
+	return read(ifs);
+}
+
+/** Reads the state of a full binary state file (base of a delta) **/
+inline bool readStateImage(const std::string &filePath, std::string &image) {
+	return readStateFile(filePath, [&image](std::istream &is) {
+		return readStateImageFrom(is, image);
+	});
+}
+
+/** Writes a serialized state as binary or delta state file.
+ * In delta format, the base of the model is required: A full state file
+ * is written (and becomes the new base), if there is no base yet or if
+ * more than half of the state changed. **/
+inline void writeStateFile(const std::string &filePath, StateFormat format,
+		std::string &image, DeltaBase *deltaBase) {
+	if (format == StateFormat::Delta && deltaBase != nullptr
+			&& !deltaBase->filePath.empty()) {
+		auto changedBlocks = getChangedBlocks(deltaBase->image, image);
+		if (changedBlocks.size() * DELTA_STATE_BLOCK_SIZE * 2 <= image.size()) {
+			writeDeltaState(filePath, *deltaBase, image, changedBlocks,
+					STATE_ARCHIVE_VERSION);
+			return;
+		}
+	}
+
+	writeStateImage(filePath, image);
+
+	if (format == StateFormat::Delta && deltaBase != nullptr) {
+		deltaBase->filePath = filePath;
+		deltaBase->image.swap(image);
+	}
+}
+
+/** Stores the object (e.g., the fields of a model) in the given format.
+ * Throws a boost::archive::archive_exception like the boost archives. **/
+template<typename T>
+void saveStateArchive(const std::string &filePath, StateFormat format,
+		const char *name, T &object, DeltaBase *deltaBase = nullptr) {
+	if (format == StateFormat::Xml) {
+		std::ofstream ofs(filePath);
+		boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
+		oa << boost::serialization::make_nvp(name, object);
+		return;
+	}
+
+	std::string image = getStateImage(name, object);
+	writeStateFile(filePath, format, image, deltaBase);
+}
+
+/** Restores the object from a binary, delta or XML state in the stream **/
+template<typename T>
+void readStateArchive(std::istream &is, const char *name, T &object) {
+	char magic[STATE_ARCHIVE_MAGIC_SIZE] = { };
+	is.read(magic, STATE_ARCHIVE_MAGIC_SIZE);
+	bool isBinary = is.gcount() == STATE_ARCHIVE_MAGIC_SIZE
+			&& std::memcmp(magic, STATE_ARCHIVE_MAGIC, STATE_ARCHIVE_MAGIC_SIZE)
+					== 0;
+	bool isDelta = is.gcount() == DELTA_STATE_MAGIC_SIZE
+			&& std::memcmp(magic, DELTA_STATE_MAGIC, DELTA_STATE_MAGIC_SIZE)
+					== 0;
+
+	if (isBinary || isDelta) {
+		uint32_t version = 0;
+		is.read(reinterpret_cast<char*>(&version), sizeof(version));
+		if (version != STATE_ARCHIVE_VERSION) {
+			throw boost::archive::archive_exception(
+					boost::archive::archive_exception::unsupported_version);
+		}
+	}
+
+	if (isBinary) {
+		boost::archive::binary_iarchive ia(is, boost::archive::no_header);
+		ia >> boost::serialization::make_nvp(name, object);
+	} else if (isDelta) {
+		// Base file and the changed blocks
+		std::string image;
+		if (!readDeltaState(is, image,
+				[](const std::string &basePath, std::string &baseImage) {
+					return readStateImage(basePath, baseImage);
+				})) {
+			throw boost::archive::archive_exception(
+					boost::archive::archive_exception::input_stream_error);
+		}
+
+		std::istringstream iss(image, std::ios::binary);
+		boost::archive::binary_iarchive ia(iss, boost::archive::no_header);
+		ia >> boost::serialization::make_nvp(name, object);
+	} else {
+		// No binary header: XML file
+		is.clear();
+		is.seekg(0);
+		boost::archive::xml_iarchive ia(is, boost::archive::no_header);
+		ia >> boost::serialization::make_nvp(name, object);
+	}
+}
+
+/** Restores the object from a binary, delta or XML state file (see
+ * readStateFile, if the file is packed or archived) **/
+template<typename T>
+void loadStateArchive(const std::string &filePath, const char *name,
+		T &object) {
+	readStateFile(filePath, [name, &object](std::istream &is) {
+		readStateArchive(is, name, object);
+	});
+}
+
+#endif /* FRASER_TEMPLATE_COMMON_PERSISTENCE_STATEARCHIVE_H_ */
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "StateWriter.h"
+#include "CheckpointStore.h"
+
+StateWriter::StateWriter(zmq::context_t &ctx) :
+		mReporter(ctx) {
+}
+
+StateWriter::~StateWriter() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mCondition.notify_all();
+
+	if (mThread.joinable()) {
+		mThread.join();
+	}
+}
+
+bool StateWriter::connectToCollector(std::string endpoint) {
+	mConnected = mReporter.connectToCollector(endpoint);
+	return mConnected;
+}
+
+void StateWriter::writeState(std::string filePath, std::string image,
+		StateFormat format, uint64_t savepointTime) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSnapshots.push_back(Snapshot { filePath, std::move(image), format,
+				savepointTime });
+
+		// The thread is started with the first savepoint
+		if (!mThread.joinable()) {
+			mThread = std::thread(&StateWriter::run, this);
+		}
+	}
+	mCondition.notify_all();
+}
+
+void StateWriter::waitUntilWritten() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	mCondition.wait(lock, [this] {
+		return mSnapshots.empty() && !mWriting;
+	});
+}
+
+void StateWriter::run() {
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while (true) {
+		mCondition.wait(lock, [this] {
+			return mStop || !mSnapshots.empty();
+		});
+
+		if (mSnapshots.empty()) {
+			// Stopped and all snapshots are written
+			break;
+		}
+
+		Snapshot snapshot = std::move(mSnapshots.front());
+		mSnapshots.pop_front();
+		mWriting = true;
+
+		lock.unlock();
+		this->writeSnapshot(snapshot);
+		lock.lock();
+
+		mWriting = false;
+		mCondition.notify_all();
+	}
+}
+
+void StateWriter::writeSnapshot(Snapshot &snapshot) {
+	// XML can only be created from the model itself, snapshots are binary
+	StateFormat format =
+			(snapshot.format == StateFormat::Delta) ?
+					StateFormat::Delta : StateFormat::Binary;
+	writeStateFile(snapshot.filePath, format, snapshot.image, &mDeltaBase);
+
+	// Durable: The data of the file is on the disk
+	syncFile(snapshot.filePath);
+
+	if (mConnected) {
+		mReporter.reportSavepointDone(snapshot.savepointTime);
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_PERSISTENCE_STATEWRITER_H_
+#define FRASER_TEMPLATE_COMMON_PERSISTENCE_STATEWRITER_H_
+
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+#include <zmq.hpp>
+
+#include "common/communication/StepReporter.h"
+#include "common/persistence/StateArchive.h"
+
+/** Defines how the models store their state at a savepoint. The mode is set
+ * with the parameter 'savepointMode' of the simulation model. **/
+enum class SavepointMode {
+	// The simulation waits until all models wrote their state files
+	Sync,
+	// The models take a snapshot of their state in memory, which is written by
+	// a background thread (binary or delta). The simulation continues
+	// immediately, the models report when their files are durable.
+	Async
+};
+
+inline SavepointMode toSavepointMode(std::string name) {
+	if (name == "async") {
+		return SavepointMode::Async;
+	}
+
+	// Default (also if the parameter is not defined)
+	return SavepointMode::Sync;
+}
+
+/** Background writer of the state snapshots of a model (async savepoints).
+ * The snapshots are written in the order of the savepoints and synced to the
+ * disk. Afterwards the savepoint is reported to the step collector of the
+ * clock source (StepReporter::reportSavepointDone). Each model owns its writer,
+ * the socket of the writer is only used by its thread. **/
+class StateWriter {
+public:
+	StateWriter(zmq::context_t &ctx);
+	/** Writes the remaining snapshots before it returns **/
+	virtual ~StateWriter();
+
+	bool connectToCollector(std::string endpoint);
+
+	/** Queues the snapshot (see getStateImage) of the savepoint **/
+	void writeState(std::string filePath, std::string image, StateFormat format,
+			uint64_t savepointTime);
+	/** Blocks until all queued snapshots are written **/
+	void waitUntilWritten();
+
+private:
+	struct Snapshot {
+		std::string filePath;
+		std::string image;
+		StateFormat format;
+		uint64_t savepointTime;
+	};
+
+	void run();
+	void writeSnapshot(Snapshot &snapshot);
+
+	StepReporter mReporter;
+	bool mConnected = false;
+	// Last full state file of the model (delta format)
+	DeltaBase mDeltaBase;
+
+	std::deque<Snapshot> mSnapshots;
+	bool mWriting = false;
+	bool mStop = false;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	std::thread mThread;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_PERSISTENCE_STATEWRITER_H_ */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_SCHEDULER_EVENTHEAP_H_
+#define FRASER_TEMPLATE_COMMON_SCHEDULER_EVENTHEAP_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+/** Future event list as binary min-heap: push and pop of the next event in
+ * O(log n), instead of sorting all events after each change.
+ * The event type has to provide getTimestamp(). Events with the same
+ * timestamp are returned in the order in which they were pushed. **/
+template<typename Event>
+class EventHeap {
+public:
+	void push(const Event &event) {
+		mEntries.push_back(Entry { event, mNumOfPushedEvents++ });
+		std::push_heap(mEntries.begin(), mEntries.end(), Later());
+	}
+
+	/** Next event (smallest timestamp) **/
+	const Event &top() const {
+		return mEntries.front().event;
+	}
+
+	void pop() {
+		std::pop_heap(mEntries.begin(), mEntries.end(), Later());
+		mEntries.pop_back();
+	}
+
+	bool empty() const {
+		return mEntries.empty();
+	}
+
+	size_t size() const {
+		return mEntries.size();
+	}
+
+	void clear() {
+		mEntries.clear();
+	}
+
+	/** Removes all events for which the predicate is true in O(n) **/
+	template<typename Predicate>
+	size_t remove(Predicate predicate) {
+		size_t size = mEntries.size();
+		mEntries.erase(
+				std::remove_if(mEntries.begin(), mEntries.end(),
+						[&predicate](const Entry &entry) {
+							return predicate(entry.event);
+						}), mEntries.end());
+		std::make_heap(mEntries.begin(), mEntries.end(), Later());
+		return size - mEntries.size();
+	}
+
+	/** All events in the order of their timestamps (e.g., to store them) **/
+	std::vector<Event> getEvents() const {
+		// Sorted from the latest to the next event (see Later)
+		std::vector<Entry> entries = mEntries;
+		std::sort_heap(entries.begin(), entries.end(), Later());
+
+		std::vector<Event> events;
+		events.reserve(entries.size());
+		for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+			events.push_back(entry->event);
+		}
+		return events;
+	}
+
+	/** Replaces the events (e.g., after they were loaded) in O(n) **/
+	void setEvents(const std::vector<Event> &events) {
+		mEntries.clear();
+		for (auto &event : events) {
+			mEntries.push_back(Entry { event, mNumOfPushedEvents++ });
+		}
+		std::make_heap(mEntries.begin(), mEntries.end(), Later());
+	}
+
+private:
+	struct Entry {
+		Event event;
+		uint64_t sequenceNumber;
+	};
+
+	// The standard heap functions create a max-heap,
+	// therefore the later event is the "smaller" one
+	struct Later {
+		bool operator()(const Entry &a, const Entry &b) const {
+			if (a.event.getTimestamp() != b.event.getTimestamp()) {
+				return a.event.getTimestamp() > b.event.getTimestamp();
+			}
+			return a.sequenceNumber > b.sequenceNumber;
+		}
+	};
+
+	std::vector<Entry> mEntries;
+	uint64_t mNumOfPushedEvents = 0;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_SCHEDULER_EVENTHEAP_H_ */
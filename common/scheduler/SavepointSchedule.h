@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_SCHEDULER_SAVEPOINTSCHEDULE_H_
+#define FRASER_TEMPLATE_COMMON_SCHEDULER_SAVEPOINTSCHEDULE_H_
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdint.h>
+
+// Returned by getNextSavepoint, if no savepoint follows
+const uint64_t NO_SAVEPOINT = std::numeric_limits<uint64_t>::max();
+
+/** Savepoints of the simulation model: The explicit savepoints are kept
+ * sorted with a cursor to the next one, the periodic rule (every interval
+ * time units) is computed. The next savepoint is cached, so the check per
+ * step is O(1). A savepoint, which was skipped by the time advance (e.g., a
+ * savepoint which is not a multiple of the step size), is taken at the first
+ * time after it. **/
+class SavepointSchedule {
+public:
+	/** Sorts the savepoints (duplicates are removed). Call start afterwards. **/
+	void setSavepoints(std::vector<uint64_t> savepoints) {
+		std::sort(savepoints.begin(), savepoints.end());
+		savepoints.erase(std::unique(savepoints.begin(), savepoints.end()),
+				savepoints.end());
+		mSavepoints.swap(savepoints);
+		mCursor = 0;
+		this->updateNextSavepoint();
+	}
+
+	/** Adds an explicit savepoint (a savepoint before the time of the
+	 * simulation is taken with the next step) **/
+	void addSavepoint(uint64_t time) {
+		auto position = std::lower_bound(mSavepoints.begin(), mSavepoints.end(),
+				time);
+		if (position != mSavepoints.end() && *position == time) {
+			return;
+		}
+
+		size_t index = position - mSavepoints.begin();
+		mSavepoints.insert(position, time);
+		if (index < mCursor) {
+			mCursor++;
+		}
+		this->updateNextSavepoint();
+	}
+
+	/** Periodic savepoints at every multiple of the interval (0 disables) **/
+	void setInterval(uint64_t interval) {
+		mInterval = interval;
+		mNextPeriodic = this->getPeriodicAfter(mStartTime);
+		this->updateNextSavepoint();
+	}
+
+	uint64_t getInterval() const {
+		return mInterval;
+	}
+
+	/** Moves the cursor to the first explicit savepoint at or after the time
+	 * and to the first periodic savepoint after the time (e.g., the time of
+	 * a loaded savepoint) **/
+	void start(uint64_t time) {
+		mStartTime = time;
+		mCursor = std::lower_bound(mSavepoints.begin(), mSavepoints.end(),
+				time) - mSavepoints.begin();
+		mNextPeriodic = this->getPeriodicAfter(time);
+		this->updateNextSavepoint();
+	}
+
+	/** Earliest savepoint which was not taken yet (or NO_SAVEPOINT) **/
+	uint64_t getNextSavepoint() const {
+		return mNextSavepoint;
+	}
+
+	/** Returns true, if a savepoint is due at the time (or was skipped before).
+	 * All due savepoints are taken at once. Periodic is set, if the savepoint is
+	 * only due to the periodic rule. **/
+	bool takeSavepoint(uint64_t time, bool &periodic) {
+		if (mNextSavepoint > time) {
+			return false;
+		}
+
+		bool explicitSavepoint = false;
+		while (mCursor < mSavepoints.size() && mSavepoints[mCursor] <= time) {
+			explicitSavepoint = true;
+			mCursor++;
+		}
+		if (mNextPeriodic <= time) {
+			mNextPeriodic = this->getPeriodicAfter(time);
+		}
+
+		periodic = !explicitSavepoint;
+		this->updateNextSavepoint();
+		return true;
+	}
+
+	/** Explicit savepoints in ascending order **/
+	const std::vector<uint64_t>& getSavepoints() const {
+		return mSavepoints;
+	}
+
+private:
+	uint64_t getPeriodicAfter(uint64_t time) const {
+		if (mInterval == 0) {
+			return NO_SAVEPOINT;
+		}
+		return (time / mInterval + 1) * mInterval;
+	}
+
+	void updateNextSavepoint() {
+		mNextSavepoint = mNextPeriodic;
+		if (mCursor < mSavepoints.size()) {
+			mNextSavepoint = std::min(mNextSavepoint, mSavepoints[mCursor]);
+		}
+	}
+
+	std::vector<uint64_t> mSavepoints;
+	// Index of the next explicit savepoint
+	size_t mCursor = 0;
+	uint64_t mStartTime = 0;
+
+	uint64_t mInterval = 0;
+	uint64_t mNextPeriodic = NO_SAVEPOINT;
+	uint64_t mNextSavepoint = NO_SAVEPOINT;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_SCHEDULER_SAVEPOINTSCHEDULE_H_ */
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_SCHEDULER_TIMINGWHEEL_H_
+#define FRASER_TEMPLATE_COMMON_SCHEDULER_TIMINGWHEEL_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+// Each level of the wheel has 64 slots (one bit per slot in the occupancy mask)
+#define TIMING_WHEEL_SLOT_BITS 6
+#define TIMING_WHEEL_NUM_OF_SLOTS (1 << TIMING_WHEEL_SLOT_BITS)
+
+/** Hierarchical timing wheel for periodic events (e.g., traffic generators)
+ * with a bounded horizon: The events are stored in the slot of their timestamp
+ * (one time unit per slot on the lowest level, 64 times more on each higher
+ * level). Insert is O(1), advance is O(1) per expired event: The events of a
+ * slot on a higher level are moved to the lower levels (at most NumOfLevels
+ * times per event) when the time reaches the slot.
+ *
+ * The wheel covers 64^NumOfLevels time units. Events beyond the horizon are
+ * not accepted (insert returns false) and have to be kept in the general
+ * scheduler (see EventHeap). The event type has to provide getTimestamp(). **/
+template<typename Event, unsigned NumOfLevels = 4>
+class TimingWheel {
+	static_assert(NumOfLevels * TIMING_WHEEL_SLOT_BITS < 64,
+			"The horizon of the timing wheel has to fit into the time type");
+
+public:
+	/** Returns false, if the event is beyond the horizon of the wheel **/
+	bool insert(const Event &event) {
+		uint64_t timestamp = event.getTimestamp();
+		if (timestamp <= mCurrentTime) {
+			// Already due: Returned with the next advance
+			mReadyEvents.push_back(event);
+			mNumOfEvents++;
+			return true;
+		}
+
+		unsigned level = getLevel(timestamp);
+		if (level >= NumOfLevels) {
+			return false;
+		}
+
+		unsigned slot = getSlot(timestamp, level);
+		mSlots[level][slot].push_back(event);
+		mOccupied[level] |= uint64_t(1) << slot;
+		mNumOfEvents++;
+		return true;
+	}
+
+	/** Moves the time forward and appends all events with a timestamp up to
+	 * the time to dueEvents (in the order of their timestamps) **/
+	void advance(uint64_t time, std::vector<Event> &dueEvents) {
+		if (!mReadyEvents.empty()) {
+			moveReadyEvents(dueEvents);
+		}
+
+		while (mNumOfEvents > 0 && mCurrentTime < time) {
+			unsigned level = 0;
+			uint64_t slots = 0;
+			for (; level < NumOfLevels; level++) {
+				slots = mOccupied[level] & getSlotsAfter(mCurrentTime, level);
+				if (slots != 0) {
+					break;
+				}
+			}
+
+			// Start of the next occupied slot (the earliest events)
+			unsigned slot = __builtin_ctzll(slots);
+			uint64_t slotTime = (mCurrentTime
+					& ~getRangeMask(level + 1))
+					| (uint64_t(slot) << (level * TIMING_WHEEL_SLOT_BITS));
+			if (slotTime > time) {
+				break;
+			}
+
+			mCurrentTime = slotTime;
+			mOccupied[level] &= ~(uint64_t(1) << slot);
+
+			if (level == 0) {
+				moveEvents(mSlots[0][slot], dueEvents);
+			} else {
+				// Distribute the events on the lower levels
+				std::vector<Event> events;
+				events.swap(mSlots[level][slot]);
+				mNumOfEvents -= events.size();
+				for (auto &event : events) {
+					insert(event);
+				}
+				moveReadyEvents(dueEvents);
+				// Keep the memory of the slot
+				events.clear();
+				mSlots[level][slot].swap(events);
+			}
+		}
+
+		if (time > mCurrentTime) {
+			mCurrentTime = time;
+		}
+	}
+
+	/** Timestamp of the next event (only valid if the wheel is not empty) **/
+	uint64_t getNextTimestamp() const {
+		uint64_t nextTimestamp = UINT64_MAX;
+		for (auto &event : mReadyEvents) {
+			nextTimestamp = std::min<uint64_t>(nextTimestamp,
+					event.getTimestamp());
+		}
+		if (nextTimestamp != UINT64_MAX) {
+			return nextTimestamp;
+		}
+
+		for (unsigned level = 0; level < NumOfLevels; level++) {
+			uint64_t slots = mOccupied[level]
+					& getSlotsAfter(mCurrentTime, level);
+			if (slots != 0) {
+				for (auto &event : mSlots[level][__builtin_ctzll(slots)]) {
+					nextTimestamp = std::min<uint64_t>(nextTimestamp,
+							event.getTimestamp());
+				}
+				break;
+			}
+		}
+		return nextTimestamp;
+	}
+
+	bool empty() const {
+		return mNumOfEvents == 0;
+	}
+
+	size_t size() const {
+		return mNumOfEvents;
+	}
+
+	uint64_t getCurrentTime() const {
+		return mCurrentTime;
+	}
+
+	/** Removes all events and sets the time of the wheel **/
+	void clear(uint64_t currentTime = 0) {
+		for (unsigned level = 0; level < NumOfLevels; level++) {
+			for (auto &slot : mSlots[level]) {
+				slot.clear();
+			}
+			mOccupied[level] = 0;
+		}
+		mReadyEvents.clear();
+		mNumOfEvents = 0;
+		mCurrentTime = currentTime;
+	}
+
+	/** Removes all events for which the predicate is true (visits all slots) **/
+	template<typename Predicate>
+	size_t remove(Predicate predicate) {
+		size_t numOfEvents = mNumOfEvents;
+		removeFrom(mReadyEvents, predicate);
+
+		for (unsigned level = 0; level < NumOfLevels; level++) {
+			for (unsigned slot = 0; slot < TIMING_WHEEL_NUM_OF_SLOTS; slot++) {
+				if (removeFrom(mSlots[level][slot], predicate)) {
+					mOccupied[level] &= ~(uint64_t(1) << slot);
+				}
+			}
+		}
+		return numOfEvents - mNumOfEvents;
+	}
+
+	/** All events in the order of their timestamps (e.g., to store them) **/
+	std::vector<Event> getEvents() const {
+		std::vector<Event> events(mReadyEvents);
+		for (unsigned level = 0; level < NumOfLevels; level++) {
+			for (auto &slot : mSlots[level]) {
+				events.insert(events.end(), slot.begin(), slot.end());
+			}
+		}
+
+		std::stable_sort(events.begin(), events.end(), isEarlier);
+		return events;
+	}
+
+private:
+	// Highest level on which the timestamp differs from the current time
+	unsigned getLevel(uint64_t timestamp) const {
+		unsigned highestBit = 63 - __builtin_clzll(timestamp ^ mCurrentTime);
+		return highestBit / TIMING_WHEEL_SLOT_BITS;
+	}
+
+	static unsigned getSlot(uint64_t timestamp, unsigned level) {
+		return (timestamp >> (level * TIMING_WHEEL_SLOT_BITS))
+				& (TIMING_WHEEL_NUM_OF_SLOTS - 1);
+	}
+
+	// Time units covered by the levels below the level
+	static uint64_t getRangeMask(unsigned level) {
+		return (uint64_t(1) << (level * TIMING_WHEEL_SLOT_BITS)) - 1;
+	}
+
+	// Slots of the level after the slot of the time
+	static uint64_t getSlotsAfter(uint64_t time, unsigned level) {
+		unsigned slot = getSlot(time, level);
+		if (slot == TIMING_WHEEL_NUM_OF_SLOTS - 1) {
+			return 0;
+		}
+		return ~uint64_t(0) << (slot + 1);
+	}
+
+	// Returns true, if the slot is empty afterwards
+	template<typename Predicate>
+	bool removeFrom(std::vector<Event> &events, Predicate &predicate) {
+		size_t size = events.size();
+		events.erase(std::remove_if(events.begin(), events.end(), predicate),
+				events.end());
+		mNumOfEvents -= size - events.size();
+		return events.empty();
+	}
+
+	void moveEvents(std::vector<Event> &events,
+			std::vector<Event> &dueEvents) {
+		dueEvents.insert(dueEvents.end(), events.begin(), events.end());
+		mNumOfEvents -= events.size();
+		events.clear();
+	}
+
+	// Events inserted in the past are in the order of insertion, not of their
+	// timestamps. The sort is stable, so events with the same timestamp keep
+	// their insertion order.
+	void moveReadyEvents(std::vector<Event> &dueEvents) {
+		std::stable_sort(mReadyEvents.begin(), mReadyEvents.end(), isEarlier);
+		moveEvents(mReadyEvents, dueEvents);
+	}
+
+	static bool isEarlier(const Event &a, const Event &b) {
+		return a.getTimestamp() < b.getTimestamp();
+	}
+
+	std::vector<Event> mSlots[NumOfLevels][TIMING_WHEEL_NUM_OF_SLOTS];
+	uint64_t mOccupied[NumOfLevels] = { };
+	// Events which were inserted with a timestamp in the past
+	std::vector<Event> mReadyEvents;
+
+	size_t mNumOfEvents = 0;
+	uint64_t mCurrentTime = 0;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_SCHEDULER_TIMINGWHEEL_H_ */
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "ConservativeSynchronizer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+ConservativeSynchronizer::ConservativeSynchronizer() {
+}
+
+ConservativeSynchronizer::~ConservativeSynchronizer() {
+}
+
+bool ConservativeSynchronizer::addInputChannel(std::string modelName,
+		uint64_t latency) {
+	if (latency == 0) {
+		std::cout << "Error: Latency of the link to " << modelName
+				<< " has to be greater than zero" << std::endl;
+		return false;
+	}
+
+	mInputChannels[modelName].latency = latency;
+	return true;
+}
+
+bool ConservativeSynchronizer::isInputChannel(const char *modelName) const {
+	return mInputChannels.find(modelName) != mInputChannels.end();
+}
+
+bool ConservativeSynchronizer::grantWindow(uint64_t windowStart,
+		uint32_t numOfSteps, uint32_t timeStep) {
+	// The last null message announced the end of the previous window
+	bool sendNullMessage = windowStart != mNextStepTime;
+
+	mWindowActive = true;
+	mNextStepTime = windowStart;
+	mWindowEnd = windowStart + uint64_t(numOfSteps) * timeStep;
+	mTimeStep = timeStep;
+
+	// The channel times are not raised to the window start: A neighbour can
+	// still have flits of the previous window in flight (its step report
+	// overtook them), they are only covered by its null message.
+	return sendNullMessage;
+}
+
+bool ConservativeSynchronizer::canSimulateNextStep() const {
+	return mWindowActive && mNextStepTime < mWindowEnd
+			&& mNextStepTime < getSafeTime();
+}
+
+void ConservativeSynchronizer::finishStep() {
+	mNextStepTime += mTimeStep;
+}
+
+bool ConservativeSynchronizer::finishWindow() {
+	if (mWindowActive && mNextStepTime >= mWindowEnd) {
+		mWindowActive = false;
+		return true;
+	}
+
+	return false;
+}
+
+void ConservativeSynchronizer::updateChannelTime(const char *modelName,
+		uint64_t senderTime) {
+	auto channel = mInputChannels.find(modelName);
+	if (channel != mInputChannels.end()) {
+		channel->second.channelTime = std::max(channel->second.channelTime,
+				senderTime);
+	}
+}
+
+void ConservativeSynchronizer::deferEvent(const char *modelName,
+		uint64_t timestamp, uint8_t eventType, uint32_t data, bool hasData) {
+	auto channel = mInputChannels.find(modelName);
+	if (channel == mInputChannels.end()) {
+		return;
+	}
+
+	DeferredEvent deferredEvent;
+	deferredEvent.deliveryTime = timestamp + channel->second.latency;
+	deferredEvent.type = eventType;
+	deferredEvent.data = data;
+	deferredEvent.hasData = hasData;
+	deferredEvent.sequenceNumber = mNumOfDeferredEvents++;
+
+	mDeferredEvents.push(deferredEvent);
+}
+
+bool ConservativeSynchronizer::popDueEvent(uint64_t simTime,
+		DeferredEvent& deferredEvent) {
+	if (mDeferredEvents.empty() || mDeferredEvents.top().deliveryTime > simTime) {
+		return false;
+	}
+
+	deferredEvent = mDeferredEvents.top();
+	mDeferredEvents.pop();
+
+	if (deferredEvent.deliveryTime < simTime) {
+		std::cout << "Error: Causality violation, event of type "
+				<< unsigned(deferredEvent.type) << " is due at "
+				<< deferredEvent.deliveryTime << " but delivered at " << simTime
+				<< std::endl;
+	}
+	return true;
+}
+
+uint64_t ConservativeSynchronizer::getSafeTime() const {
+	uint64_t safeTime = std::numeric_limits<uint64_t>::max();
+
+	for (auto &channel : mInputChannels) {
+		safeTime = std::min(safeTime,
+				channel.second.channelTime + channel.second.latency);
+	}
+
+	return safeTime;
+}
+
+std::map<std::string, uint64_t> ConservativeSynchronizer::getChannelTimes() const {
+	std::map<std::string, uint64_t> channelTimes;
+	for (auto &channel : mInputChannels) {
+		channelTimes[channel.first] = channel.second.channelTime;
+	}
+	return channelTimes;
+}
+
+void ConservativeSynchronizer::setChannelTimes(
+		const std::map<std::string, uint64_t> &channelTimes) {
+	// Only channels of the current configuration are restored
+	for (auto &channelTime : channelTimes) {
+		auto channel = mInputChannels.find(channelTime.first);
+		if (channel != mInputChannels.end()) {
+			channel->second.channelTime = channelTime.second;
+		}
+	}
+}
+
+std::vector<DeferredEvent> ConservativeSynchronizer::getDeferredEvents() const {
+	// The priority queue provides no iteration
+	auto deferredEvents = mDeferredEvents;
+	std::vector<DeferredEvent> events;
+	while (!deferredEvents.empty()) {
+		events.push_back(deferredEvents.top());
+		deferredEvents.pop();
+	}
+	return events;
+}
+
+void ConservativeSynchronizer::setDeferredEvents(
+		const std::vector<DeferredEvent> &deferredEvents) {
+	mDeferredEvents = decltype(mDeferredEvents)();
+	for (auto &deferredEvent : deferredEvents) {
+		mDeferredEvents.push(deferredEvent);
+	}
+}
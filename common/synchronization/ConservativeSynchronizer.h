@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_COMMON_SYNCHRONIZATION_CONSERVATIVESYNCHRONIZER_H_
+#define FRASER_TEMPLATE_COMMON_SYNCHRONIZATION_CONSERVATIVESYNCHRONIZER_H_
+
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/vector.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/split_member.hpp>
+
+/** Event of a neighbour, which is delivered to the model after the link latency. **/
+struct DeferredEvent {
+	uint64_t deliveryTime = 0;
+	uint8_t type = 0; // EventType (resources/idl/event.fbs)
+	uint32_t data = 0;
+	bool hasData = false;
+	// Events with the same delivery time are delivered in the order of arrival
+	uint64_t sequenceNumber = 0;
+
+	bool operator>(const DeferredEvent& other) const {
+		if (deliveryTime != other.deliveryTime) {
+			return deliveryTime > other.deliveryTime;
+		}
+		return sequenceNumber > other.sequenceNumber;
+	}
+
+	template<typename Archive>
+	void serialize(Archive& archive, const unsigned int) {
+		archive & boost::serialization::make_nvp("DeliveryTime", deliveryTime);
+		archive & boost::serialization::make_nvp("Type", type);
+		archive & boost::serialization::make_nvp("Data", data);
+		archive & boost::serialization::make_nvp("HasData", hasData);
+		archive & boost::serialization::make_nvp("SequenceNumber", sequenceNumber);
+	}
+};
+
+/** Conservative synchronization (Chandy-Misra-Bryant) of a model with the models it
+ * depends on (input channels). Each input channel has a latency (lookahead), which is
+ * defined in the hosts-configuration file (ModelReference/@latency).
+ *
+ * After each step, a model sends a null message with the time of its next step to its
+ * neighbours. A model simulates a step only if all input channels guarantee that no
+ * event for this step can arrive anymore (step < channel time + latency).
+ * The simulation model still grants the time windows, within a window the models run
+ * independently of each other.
+ *
+ * The channel times only advance with the null messages. They are published after the
+ * other events of the sender's step on the same socket, whereas the clock and the step
+ * reports use other sockets and can overtake them. **/
+class ConservativeSynchronizer {
+public:
+	ConservativeSynchronizer();
+	virtual ~ConservativeSynchronizer();
+
+	/** Returns false, if the latency is zero (would lead to a deadlock) **/
+	bool addInputChannel(std::string modelName, uint64_t latency);
+	// Model names are looked up without copying them from the received event
+	bool isInputChannel(const char *modelName) const;
+
+	/** Time window granted by the simulation model. Returns true, if the model has
+	 * to send a null message with the window start, because the window does not
+	 * start at the time of its last null message (e.g., idle steps were skipped). **/
+	bool grantWindow(uint64_t windowStart, uint32_t numOfSteps,
+			uint32_t timeStep);
+	bool canSimulateNextStep() const;
+	uint64_t getNextStepTime() const {
+		return mNextStepTime;
+	}
+	void finishStep();
+	/** Returns true once, after all steps of the granted window were simulated **/
+	bool finishWindow();
+
+	// Null message of a neighbour: It sends no events before the given time
+	void updateChannelTime(const char *modelName, uint64_t senderTime);
+
+	// Events of neighbours (an event, which is due before the simulated step,
+	// violates the causality and is reported)
+	void deferEvent(const char *modelName, uint64_t timestamp, uint8_t eventType,
+			uint32_t data, bool hasData);
+	bool popDueEvent(uint64_t simTime, DeferredEvent& deferredEvent);
+
+	/** Stores the channel times and the deferred events (savepoints are taken
+	 * between two windows). The latencies are defined by the configuration. **/
+	template<typename Archive>
+	void save(Archive& archive, const unsigned int) const {
+		std::map<std::string, uint64_t> channelTimes = getChannelTimes();
+		std::vector<DeferredEvent> deferredEvents = getDeferredEvents();
+		archive << boost::serialization::make_nvp("ChannelTimes", channelTimes);
+		archive << boost::serialization::make_nvp("DeferredEvents", deferredEvents);
+		archive << boost::serialization::make_nvp("NumOfDeferredEvents",
+				mNumOfDeferredEvents);
+	}
+	template<typename Archive>
+	void load(Archive& archive, const unsigned int) {
+		std::map<std::string, uint64_t> channelTimes;
+		std::vector<DeferredEvent> deferredEvents;
+		archive >> boost::serialization::make_nvp("ChannelTimes", channelTimes);
+		archive >> boost::serialization::make_nvp("DeferredEvents", deferredEvents);
+		archive >> boost::serialization::make_nvp("NumOfDeferredEvents",
+				mNumOfDeferredEvents);
+		setChannelTimes(channelTimes);
+		setDeferredEvents(deferredEvents);
+	}
+	BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+private:
+	std::map<std::string, uint64_t> getChannelTimes() const;
+	void setChannelTimes(const std::map<std::string, uint64_t> &channelTimes);
+	std::vector<DeferredEvent> getDeferredEvents() const;
+	void setDeferredEvents(const std::vector<DeferredEvent> &deferredEvents);
+
+	/** Steps before this time can be simulated safely **/
+	uint64_t getSafeTime() const;
+
+	struct InputChannel {
+		uint64_t latency = 0;
+		uint64_t channelTime = 0;
+	};
+	std::map<std::string, InputChannel, std::less<>> mInputChannels;
+	std::priority_queue<DeferredEvent, std::vector<DeferredEvent>,
+			std::greater<DeferredEvent>> mDeferredEvents;
+
+	bool mWindowActive = false;
+	uint64_t mNextStepTime = 0;
+	uint64_t mWindowEnd = 0;
+	uint32_t mTimeStep = 0;
+	uint64_t mNumOfDeferredEvents = 0;
+};
+
+#endif /* FRASER_TEMPLATE_COMMON_SYNCHRONIZATION_CONSERVATIVESYNCHRONIZER_H_ */
@@ -8,5 +8,6 @@
 ../models/processing_element/build/bin/processing_element -n processing_element_1 &
 ../models/processing_element/build/bin/processing_element -n processing_element_2 &
 ../models/processing_element/build/bin/processing_element -n processing_element_3 &
+../models/event_queue_1/build/bin/event_queue_1 &
 ../models/systemc_adapter/build/bin/systemc_adapter &
 ../models/simulation_model/build/bin/simulation_model --create-config-files ../configurations/config_0/
\ No newline at end of file
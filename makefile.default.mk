@@ -15,7 +15,7 @@ RM=rm -f
 INCLUDES = -I../../ -I../ -I/usr/local/include -I../../fraser/src -I../../models -I../../../cpp -I../../../systemc/proc_element $(SYSTEMC_INC_DIR)
 CXXFLAGS := -std=c++1y -g -Wall ${INCLUDES}
 LDFLAGS = -L/usr/local/lib -L/usr/lib/x86_64-linux-gnu $(SYSTEMC_LDFLAGS)
-LIBS= -lzmq -lboost_serialization -lboost_system -lboost_filesystem -lboost_thread -lpugixml $(SYSTEMC_LIBS)
+LIBS= -lzmq -lboost_serialization -lboost_system -lboost_filesystem -lboost_thread -lpugixml -lz $(SYSTEMC_LIBS)
 
 vpath %.cpp $(dir $(SRCS))
 
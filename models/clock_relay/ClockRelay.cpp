@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include "ClockRelay.h"
+#include "common/communication/Endpoints.h"
+
+#include <algorithm>
+#include <iostream>
+
+ClockRelay::ClockRelay(zmq::context_t &ctx, std::string name,
+		std::string description) :
+		mName(name), mDescription(description), mCtx(ctx), mFrontend(mCtx,
+		ZMQ_SUB), mBackend(mCtx, ZMQ_PUB), mSubscriber(mCtx), mDealer(mCtx,
+				mName), mStepCollector(mCtx), mStepReporter(mCtx) {
+
+	registerInterruptSignal();
+
+	mRun = this->prepare();
+}
+
+ClockRelay::~ClockRelay() {
+	mFrontend.close();
+	mBackend.close();
+}
+
+void ClockRelay::init() {
+}
+
+bool ClockRelay::prepare() {
+	mSubscriber.setOwnershipName(mName);
+
+	std::string numOfLocalModels = mDealer.getModelParameter(mName,
+			"numOfClockSubscribers");
+	if (!numOfLocalModels.empty()) {
+		mNumOfLocalModels = std::stoull(numOfLocalModels);
+	}
+
+	for (auto endpoint : splitEndpoints(
+			mDealer.getModelParameter(mName, "bindEndpoints"))) {
+		try {
+			mBackend.bind(endpoint);
+		} catch (std::exception &e) {
+			std::cout << mName << ": Could not bind to " << endpoint << ": "
+					<< e.what() << std::endl;
+			return false;
+		}
+	}
+
+	if (!mStepCollector.bindSocket(
+			mDealer.getModelParameter(mName, "stepBindEndpoints"))) {
+		return false;
+	}
+
+	// Subscribe to all events of the simulation model (before the
+	// synchronization), so that no event is lost until the local
+	// models are connected
+	try {
+		mFrontend.connect(
+				mDealer.getModelParameter("simulation_model", "endpoint"));
+		mFrontend.setsockopt(ZMQ_SUBSCRIBE, "", 0);
+	} catch (std::exception &e) {
+		std::cout << mName << ": Could not connect to simulation model: "
+				<< e.what() << std::endl;
+		return false;
+	}
+
+	if (!mStepReporter.connectToCollector(
+			mDealer.getModelParameter("simulation_model", "stepEndpoint"))) {
+		return false;
+	}
+
+	// Synchronization
+	if (!mSubscriber.prepareSubSynchronization(
+			mDealer.getIPFrom("simulation_model"),
+			mDealer.getSynchronizationPort())) {
+		return false;
+	}
+
+	if (!mSubscriber.synchronizeSub()) {
+		return false;
+	}
+
+	return true;
+}
+
+void ClockRelay::run() {
+	zmq::pollitem_t items[] = {
+			{ static_cast<void*>(mFrontend), 0, ZMQ_POLLIN, 0 },
+			mStepCollector.getPollItem() };
+
+	while (mRun) {
+		zmq::poll(items, 2, -1);
+
+		if (items[0].revents & ZMQ_POLLIN) {
+			this->forwardClockEvent();
+		}
+
+		if (items[1].revents & ZMQ_POLLIN) {
+			this->aggregateStepReport();
+		}
+
+		if (interruptOccured) {
+			break;
+		}
+	}
+}
+
+void ClockRelay::forwardClockEvent() {
+	bool isTopic = true;
+	int more = 1;
+
+	while (more) {
+		zmq::message_t message;
+		mFrontend.recv(&message);
+
+		size_t moreSize = sizeof(more);
+		mFrontend.getsockopt(ZMQ_RCVMORE, &more, &moreSize);
+
+		// The relay stops with the models of its host
+		if (isTopic
+				&& std::string(static_cast<char*>(message.data()),
+						message.size()) == "End") {
+			mRun = false;
+		}
+		isTopic = false;
+
+		mBackend.send(message, more ? ZMQ_SNDMORE : 0);
+	}
+}
+
+void ClockRelay::aggregateStepReport() {
+	uint64_t nextActivityTime = NO_ACTIVITY;
+	if (mStepCollector.receiveReport(nextActivityTime)
+			== ReportType::Savepoint) {
+		// Savepoint reports are not aggregated, the simulation model counts them
+		for (auto &reports : mStepCollector.takeSavepointReports()) {
+			mStepReporter.reportSavepointDone(reports.first, reports.second);
+		}
+		return;
+	}
+
+	mNextActivityTime = std::min(mNextActivityTime, nextActivityTime);
+	mNumOfStepReports++;
+
+	// Report upstream, when all local models finished the time window
+	if (mNumOfStepReports >= mNumOfLocalModels) {
+		mStepReporter.reportStepDone(mNextActivityTime);
+		mNumOfStepReports = 0;
+		mNextActivityTime = NO_ACTIVITY;
+	}
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#ifndef FRASER_TEMPLATE_MODELS_CLOCK_RELAY_CLOCKRELAY_H_
+#define FRASER_TEMPLATE_MODELS_CLOCK_RELAY_CLOCKRELAY_H_
+
+#include <string>
+#include <stdint.h>
+#include <zmq.hpp>
+
+#include "communication/zhelpers.hpp"
+#include "communication/Subscriber.h"
+#include "communication/Dealer.h"
+#include "common/communication/StepReporter.h"
+#include "common/communication/StepCollector.h"
+#include "interfaces/IModel.h"
+
+/** The clock relay forms a tree of the clock distribution: It subscribes once to
+ * the simulation model, re-publishes its events (SimTimeChanged, SaveState, ...)
+ * to the models of its host and aggregates their step reports into a single
+ * report to the simulation model (savepoint reports are forwarded). Models
+ * use the relay of their host, if the hosts-configuration file defines one
+ * (see ConfigurationServer). **/
+class ClockRelay: public virtual IModel {
+public:
+	ClockRelay(zmq::context_t &ctx, std::string name,
+			std::string description);
+	virtual ~ClockRelay();
+
+	// IModel
+	virtual void init() override;
+	virtual bool prepare() override;
+	virtual void run() override;
+	virtual std::string getName() const override {
+		return mName;
+	}
+	virtual std::string getDescription() const override {
+		return mDescription;
+	}
+
+private:
+	// IModel
+	std::string mName;
+	std::string mDescription;
+
+	/** Re-publishes one (multipart) event of the simulation model **/
+	void forwardClockEvent();
+	/** Adds one step report of a local model to the aggregated report
+	 * (savepoint reports are forwarded) **/
+	void aggregateStepReport();
+
+	zmq::context_t &mCtx;
+	zmq::socket_t mFrontend; // ZMQ-SUB (simulation model)
+	zmq::socket_t mBackend;  // ZMQ-PUB (local models)
+	Subscriber mSubscriber;  // Only for the synchronization
+	Dealer mDealer;
+	StepCollector mStepCollector; // ZMQ-PULL (local models)
+	StepReporter mStepReporter;   // ZMQ-PUSH (simulation model)
+
+	bool mRun = false;
+
+	// Number of models which receive the clock from this relay
+	uint64_t mNumOfLocalModels = 0;
+	uint64_t mNumOfStepReports = 0;
+	uint64_t mNextActivityTime = NO_ACTIVITY;
+};
+
+#endif /* FRASER_TEMPLATE_MODELS_CLOCK_RELAY_CLOCKRELAY_H_ */
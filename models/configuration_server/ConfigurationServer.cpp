@@ -15,9 +15,26 @@
 #include <iostream>
 
 #define FRONTEND_PORT std::string("5570")
+#define IPC_DIRECTORY std::string("/tmp/")
+
+// Endpoint of a socket on the same host: The tcp port of the socket is part
+// of the path, so that the models of simulations, which run on the same host
+// at the same time (with other ports), do not bind to the same path
+static std::string getIpcEndpoint(std::string name, std::string socketName,
+		std::string port) {
+	return "ipc://" + IPC_DIRECTORY + "fraser_" + port + "_" + name + "."
+			+ socketName;
+}
+
+static bool endsWith(std::string text, std::string suffix) {
+	return text.size() >= suffix.size()
+			&& text.compare(text.size() - suffix.size(), suffix.size(), suffix)
+					== 0;
+}
 
-ConfigurationServer::ConfigurationServer(std::string modelsConfigFilePath) :
-		mCtx(1), mFrontend(mCtx,
+ConfigurationServer::ConfigurationServer(zmq::context_t &ctx,
+		std::string modelsConfigFilePath) :
+		mCtx(ctx), mFrontend(mCtx,
 		ZMQ_ROUTER), mModelsConfigFilePath(modelsConfigFilePath) {
 
 	registerInterruptSignal();
@@ -29,6 +46,9 @@ ConfigurationServer::ConfigurationServer(std::string modelsConfigFilePath) :
 		setModelPortNumbers();
 		setModelIPAddresses();
 		setModelParameters();
+		setLinkLatencies();
+		setClockSources();
+		setModelEndpoints();
 
 		try {
 			mFrontend.bind("tcp://*:" + FRONTEND_PORT);
@@ -83,6 +103,30 @@ bool ConfigurationServer::setModelPortNumbers() {
 	}
 
 	mModelInformation["sim_sync_port"] = std::to_string(portCnt);
+	portCnt++;
+
+	// Step barrier of the simulation model (requested like a model parameter)
+	if (portCnt > mMaxPort) {
+		std::cout << "Error: Exceeded max. port number (" << mMaxPort
+				<< ") --> Increase the interval" << std::endl;
+		return false;
+	}
+	mModelInformation["simulation_model_stepPort"] = std::to_string(portCnt);
+	portCnt++;
+
+	// Step barriers of the clock relays
+	for (auto name : mModelNames) {
+		if (isClockRelay(name)) {
+			if (portCnt > mMaxPort) {
+				std::cout << "Error: Exceeded max. port number (" << mMaxPort
+						<< ") --> Increase the interval" << std::endl;
+				return false;
+			}
+
+			mModelInformation[name + "_stepPort"] = std::to_string(portCnt);
+			portCnt++;
+		}
+	}
 
 	return true;
 }
@@ -145,6 +189,155 @@ void ConfigurationServer::setModelParameters() {
 
 }
 
+void ConfigurationServer::setLinkLatencies() {
+	for (auto name : mModelNames) {
+
+		// Search for the first matching entry with the given hint attribute
+		std::string specificModelSearch = ".//Models/Model[@id='" + name + "']";
+
+		pugi::xpath_node xpathModel = mRootNode.select_node(
+				specificModelSearch.c_str());
+
+		if (xpathModel) {
+			// Latency (lookahead) of the events, which the model receives from its dependencies
+			std::string latencySearch =
+					".//Dependencies/ModelReference[@latency]";
+			auto xpathModelDepends = xpathModel.node().select_nodes(
+					latencySearch.c_str());
+
+			for (auto &modelDepend : xpathModelDepends) {
+				std::string modelID =
+						modelDepend.node().attribute("modelID").value();
+
+				mModelInformation[name + "_" + modelID + "_latency"] =
+						modelDepend.node().attribute("latency").value();
+			}
+		}
+	}
+}
+
+void ConfigurationServer::setClockSources() {
+	// The first clock relay of a host distributes the clock to the other models of the host
+	std::map<std::string, std::string> hostRelays;
+	for (auto name : mModelNames) {
+		if (isClockRelay(name)) {
+			hostRelays.insert( { getHostID(name), name });
+		}
+	}
+
+	std::map<std::string, uint64_t> numOfClockSubscribers;
+	for (auto name : mModelNames) {
+		if (name == "configuration_server" || name == "simulation_model"
+				|| isClockRelay(name)) {
+			continue;
+		}
+
+		std::string clockSource = "simulation_model";
+		auto hostRelay = hostRelays.find(getHostID(name));
+		if (hostRelay != hostRelays.end()) {
+			clockSource = hostRelay->second;
+		}
+
+		mModelInformation[name + "_clockSource"] = clockSource;
+		numOfClockSubscribers[clockSource]++;
+	}
+
+	// Relays without models would never report a finished step
+	for (auto &hostRelay : hostRelays) {
+		if (numOfClockSubscribers[hostRelay.second] > 0) {
+			mModelInformation[hostRelay.second + "_clockSource"] =
+					"simulation_model";
+			numOfClockSubscribers["simulation_model"]++;
+		}
+	}
+
+	// Number of step reports, which a clock source has to wait for
+	mModelInformation["simulation_model_numOfClockSubscribers"] = "0";
+	for (auto &clockSource : numOfClockSubscribers) {
+		mModelInformation[clockSource.first + "_numOfClockSubscribers"] =
+				std::to_string(clockSource.second);
+	}
+}
+
+void ConfigurationServer::setModelEndpoints() {
+	for (auto name : mModelNames) {
+		if (name == "configuration_server") {
+			continue;
+		}
+
+		// Models on other hosts connect via tcp, models on the same host via ipc
+		// and models in the same process via inproc
+		std::vector<std::pair<std::string, std::string>> sockets = { {
+				"events", "_port" }, { "steps", "_stepPort" } };
+		for (auto &socket : sockets) {
+			std::string port = mModelInformation[name + socket.second];
+			if (port.empty()) {
+				continue;
+			}
+
+			std::string endpoints = "tcp://*:" + port + " "
+					+ getIpcEndpoint(name, socket.first, port);
+			if (!getProcessID(name).empty()) {
+				endpoints += " inproc://" + name + "/" + socket.first;
+			}
+
+			std::string key = socket.first == "events" ?
+					"_bindEndpoints" : "_stepBindEndpoints";
+			mModelInformation[name + key] = endpoints;
+		}
+	}
+}
+
+std::string ConfigurationServer::getEndpoint(std::string requester,
+		std::string target, std::string socketName) {
+	std::string processID = getProcessID(target);
+	if (!processID.empty() && processID == getProcessID(requester)) {
+		return "inproc://" + target + "/" + socketName;
+	}
+
+	std::string port = mModelInformation[target
+			+ (socketName == "events" ? "_port" : "_stepPort")];
+	if (getHostID(target) == getHostID(requester)) {
+		return getIpcEndpoint(target, socketName, port);
+	}
+
+	return "tcp://" + mModelInformation[target + "_ip"] + ":" + port;
+}
+
+bool ConfigurationServer::isClockRelay(std::string modelName) {
+	std::string specificModelSearch = ".//Models/Model[@id='" + modelName
+			+ "']";
+
+	pugi::xpath_node xpathModel = mRootNode.select_node(
+			specificModelSearch.c_str());
+
+	// The type of a model is the name of its folder within the models-folder
+	std::string path = xpathModel.node().attribute("path").value();
+	std::string type = path.substr(path.find_last_of('/') + 1);
+
+	return type == "clock_relay";
+}
+
+std::string ConfigurationServer::getHostID(std::string modelName) {
+	std::string specificModelSearch = ".//Models/Model[@id='" + modelName
+			+ "']";
+
+	pugi::xpath_node xpathModel = mRootNode.select_node(
+			specificModelSearch.c_str());
+
+	return xpathModel.node().child("HostReference").attribute("hostID").value();
+}
+
+std::string ConfigurationServer::getProcessID(std::string modelName) {
+	std::string specificModelSearch = ".//Models/Model[@id='" + modelName
+			+ "']";
+
+	pugi::xpath_node xpathModel = mRootNode.select_node(
+			specificModelSearch.c_str());
+
+	return xpathModel.node().attribute("process").value();
+}
+
 int ConfigurationServer::getNumberOfModels() {
 	std::string allModelsSearch = ".//Models/Model";
 	pugi::xpath_node_set xpathAllModels = mRootNode.select_nodes(
@@ -229,6 +422,14 @@ void ConfigurationServer::run() {
 		} else if (msg == "model_dependencies") {
 			std::string sought = "_dependencies";
 			v_send(mFrontend, getModelDependencies(identity));
+		} else if (endsWith(msg, "_stepEndpoint")) {
+			std::string target = msg.substr(0,
+					msg.size() - std::string("_stepEndpoint").size());
+			s_send(mFrontend, getEndpoint(identity, target, "steps"));
+		} else if (endsWith(msg, "_endpoint")) {
+			std::string target = msg.substr(0,
+					msg.size() - std::string("_endpoint").size());
+			s_send(mFrontend, getEndpoint(identity, target, "events"));
 		} else {
 			s_send(mFrontend, getModelInformation(msg));
 		}
@@ -28,7 +28,8 @@
 
 class ConfigurationServer: public virtual IModel {
 public:
-	ConfigurationServer(std::string modelsConfigFilePath);
+	ConfigurationServer(zmq::context_t &ctx,
+			std::string modelsConfigFilePath);
 	virtual ~ConfigurationServer();
 
 	// IModel
@@ -61,12 +62,30 @@ public:
 
 	void setModelParameters();
 
+	// Set link latencies (lookahead for the conservative synchronization)
+	void setLinkLatencies();
+
+	// Set the clock source of each model (simulation model or clock relay of the host)
+	void setClockSources();
+
+	// Set the endpoints, which the sockets of each model bind to
+	void setModelEndpoints();
+
+	/** Returns the endpoint of the given socket ("events" or "steps") of the target model
+	 * for the requesting model: inproc (same process), ipc (same host) or tcp **/
+	std::string getEndpoint(std::string requester, std::string target,
+			std::string socketName);
+
+	bool isClockRelay(std::string modelName);
+	std::string getHostID(std::string modelName);
+	std::string getProcessID(std::string modelName);
+
 private:
 	// IModel
 	std::string mName;
 	std::string mDescription;
 
-	zmq::context_t mCtx;
+	zmq::context_t &mCtx;
 	zmq::socket_t mFrontend;
 
 	pugi::xml_node mRootNode;
@@ -16,7 +16,8 @@
 int main(int argc, char* argv[]) {
 	if (argc > 2) {
 		if (static_cast<std::string>(argv[1]) == "--config-file") {
-			ConfigurationServer configServerModel(argv[2]);
+			zmq::context_t ctx(1);
+			ConfigurationServer configServerModel(ctx, argv[2]);
 			try {
 				configServerModel.run();
 
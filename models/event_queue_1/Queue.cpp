@@ -14,11 +14,12 @@
 #include "Queue.h"
 
 #include <iostream>
+#include <algorithm>
 
-Queue::Queue(std::string name, std::string description) :
-		mName(name), mDescription(description), mCtx(1), mSubscriber(mCtx), mPublisher(
-				mCtx), mDealer(mCtx, mName), mReceivedEvent(NULL), mCurrentSimTime(
-				-1) {
+Queue::Queue(zmq::context_t &ctx, std::string name, std::string description) :
+		mName(name), mDescription(description), mCtx(ctx), mSubscriber(mCtx), mPublisher(
+				mCtx), mDealer(mCtx, mName), mStepReporter(mCtx), mReceivedEvent(NULL), mCurrentSimTime(
+				-1), mStateWriter(mCtx) {
 
 	registerInterruptSignal();
 
@@ -32,27 +33,68 @@ Queue::~Queue() {
 
 void Queue::init() {
 	// Set or calculate other parameters ...
-	mEventSet.push_back(
+	scheduleEvent(
 			Event("Local_Req", 0b001111111100011, 100, 100, -1,
 					Priority::NORMAL_PRIORITY));
+	mInitialized = true;
 }
 
 bool Queue::prepare() {
 	mSubscriber.setOwnershipName(mName);
+	// Events of other hosts are verified before they are accessed
+	mSubscriber.setEventVerifier(
+			&verifyEventBuffer<event::VerifyEventBuffer>);
+	mClockMode = toClockMode(
+			mDealer.getModelParameter("simulation_model", "clockMode"));
+	mStateFormat = toStateFormat(
+			mDealer.getModelParameter("simulation_model", "stateFormat"));
+	mSavepointMode = toSavepointMode(
+			mDealer.getModelParameter("simulation_model", "savepointMode"));
+
+	if (!mPublisher.bindSocket(
+			mDealer.getModelParameter(mName, "bindEndpoints"))) {
+		return false;
+	}
+
+	// The clock is distributed by the clock relay of the host (if defined)
+	std::string clockSource = mDealer.getModelParameter(mName, "clockSource");
+	if (clockSource.empty()) {
+		clockSource = "simulation_model";
+	}
+
+	// Events of the clock source are received on the high-priority lane
+	if (!mSubscriber.connectToControlPub(
+			mDealer.getModelParameter(clockSource, "endpoint"))) {
+		return false;
+	}
 
-	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName))) {
+	if (!mStepReporter.connectToCollector(
+			mDealer.getModelParameter(clockSource, "stepEndpoint"))) {
 		return false;
 	}
 
-	if (!mSubscriber.connectToPub(mDealer.getIPFrom("simulation_model"),
-			mDealer.getPortNumFrom("simulation_model"))) {
+	// Asynchronous savepoints are reported as durable by the state writer
+	if (mSavepointMode == SavepointMode::Async
+			&& !mStateWriter.connectToCollector(
+					mDealer.getModelParameter(clockSource, "stepEndpoint"))) {
 		return false;
 	}
 
-	mSubscriber.subscribeTo("SimTimeChanged");
-	mSubscriber.subscribeTo("End");
-	mSubscriber.subscribeTo("LoadState");
-	mSubscriber.subscribeTo("SaveState");
+	mSubscriber.subscribeToControl("SimTimeChanged");
+	mSubscriber.subscribeToControl("End");
+	mSubscriber.subscribeToControl("LoadState");
+	mSubscriber.subscribeToControl("SaveState");
+	mSubscriber.subscribeToControl("ExportState");
+
+	// Future event service: Models, which schedule events, are dependencies
+	// of the queue and address their requests to it (see LinkTopics.h)
+	for (auto depModel : mDealer.getModelDependencies()) {
+		if (!mSubscriber.connectToPub(
+				mDealer.getModelParameter(depModel, "endpoint"))) {
+			return false;
+		}
+	}
+	mSubscriber.subscribeTo(getLinkPrefix(mName));
 
 	// Synchronization
 	if (!mSubscriber.prepareSubSynchronization(
@@ -70,8 +112,9 @@ bool Queue::prepare() {
 
 void Queue::run() {
 	while (mRun) {
-		mSubscriber.receiveEvent();
-		this->handleEvent();
+		if (mSubscriber.receiveEvent()) {
+			this->handleEvent();
+		}
 
 		if (interruptOccured) {
 			break;
@@ -79,73 +122,202 @@ void Queue::run() {
 	}
 }
 
+void Queue::scheduleEvent(const Event &event) {
+	// Periodic events are rescheduled in O(1) by the timing wheel,
+	// all other events (and events beyond its horizon) by the heap
+	if (event.getRepeat() == 0 || !mPeriodicEvents.insert(event)) {
+		mEventQueue.push(event);
+	}
+}
+
+uint64_t Queue::getNextActivityTime() const {
+	uint64_t nextActivityTime = NO_ACTIVITY;
+	if (!mEventQueue.empty()) {
+		nextActivityTime = mEventQueue.top().getTimestamp();
+	}
+	if (!mPeriodicEvents.empty()) {
+		nextActivityTime = std::min(nextActivityTime,
+				mPeriodicEvents.getNextTimestamp());
+	}
+	return nextActivityTime;
+}
+
 void Queue::updateEvents() {
+	// Periodic events of the step are rescheduled (O(log n) each). This is done
+	// after all due events were taken, so that an event with period 0 is
+	// published only once per step.
+	for (auto &dueEvent : mDueEvents) {
+		if (dueEvent.getRepeat() != 0) {
+			int timestamp = mCurrentSimTime + dueEvent.getPeriod();
+			dueEvent.setTimestamp(timestamp);
+
+			if (dueEvent.getRepeat() != -1) {
+				dueEvent.setRepeat(dueEvent.getRepeat() - 1);
+			}
 
-	if (mEventSet.back().getRepeat() != 0) {
-		int timestamp = mCurrentSimTime + mEventSet.back().getPeriod();
-		mEventSet.back().setTimestamp(timestamp);
+			scheduleEvent(dueEvent);
+		}
+	}
+	mDueEvents.clear();
+}
 
-		if (mEventSet.back().getRepeat() != -1) {
-			mEventSet.back().setRepeat(mEventSet.back().getRepeat() - 1);
+void Queue::simulateStep() {
+	// Take all events which are due in this step (timestamp order)
+	while (!mEventQueue.empty()
+			&& mEventQueue.top().getTimestamp() <= mCurrentSimTime) {
+		mDueEvents.push_back(mEventQueue.top());
+		mEventQueue.pop();
+	}
+
+	// Merge the due periodic events (both are in timestamp order)
+	size_t numOfDueEvents = mDueEvents.size();
+	mPeriodicEvents.advance(mCurrentSimTime, mDueEvents);
+	std::inplace_merge(mDueEvents.begin(), mDueEvents.begin() + numOfDueEvents,
+			mDueEvents.end(), [](const Event &a, const Event &b) {
+				return a.getTimestamp() < b.getTimestamp();
+			});
+
+	for (auto &dueEvent : mDueEvents) {
+		// Events are late, if they were due before the current step
+		// (e.g., the step size is larger than their period)
+		uint64_t lateness = mCurrentSimTime - dueEvent.getTimestamp();
+		if (lateness > 0) {
+			mNumOfLateEvents++;
+			mTotalLateness += lateness;
+			mMaxLateness = std::max(mMaxLateness, lateness);
 		}
 
-		mScheduler.scheduleEvents(mEventSet);
+		dueEvent.setCurrentSimTime(mCurrentSimTime);
+		// Reuse the memory of the previous event
+		mFbb.Clear();
+		mFbb.Finish(
+				event::CreateEvent(mFbb, mFbb.CreateString(dueEvent.getName()),
+						dueEvent.getTimestamp(),
+						event::Priority_NORMAL_PRIORITY, dueEvent.getRepeat(),
+						dueEvent.getPeriod(), event::EventData_Flit,
+						mFbb.CreateStruct(event::Flit(dueEvent.getData())).Union(),
+						mFbb.CreateString(mName), event::EventType_TimedEvent));
+
+		// Sent together with the other events of the time window
+		mPublisher.queueEvent(dueEvent.getName(), mFbb.GetBufferPointer(),
+				mFbb.GetSize());
+	}
+
+	this->updateEvents();
+}
+
+void Queue::handleRequest(const event::Event* request) {
+	if (request->name() == nullptr) {
+		return;
+	}
+	std::string eventName = request->name()->str();
+
+	// Models schedule and cancel only their own events (see LinkTopics.h)
+	std::string prefix = (request->source() != nullptr) ?
+			getLinkPrefix(request->source()->str()) : "";
+	if (prefix.empty() || eventName.compare(0, prefix.size(), prefix) != 0) {
+		std::cout << mName << ": Rejected the request for " << eventName
+				<< " (the event is not addressed to the requester)" << std::endl;
+		return;
+	}
 
-	} else {
-		mEventSet.pop_back();
+	if (request->type() == event::EventType_ScheduleEvent) {
+		// Events without a flit are scheduled with the data 0
+		uint32_t data = 0;
+		getFlit(request, data);
+
+		// Requests for the past are published in the next step (late events)
+		scheduleEvent(
+				Event(eventName, data, request->timestamp(), request->period(),
+						static_cast<int>(request->repeat()),
+						Priority::NORMAL_PRIORITY));
+
+	} else if (request->type() == event::EventType_CancelEvent) {
+		auto hasName = [&eventName](const Event &event) {
+			return event.getName() == eventName;
+		};
+		mEventQueue.remove(hasName);
+		mPeriodicEvents.remove(hasName);
 	}
 }
 
 void Queue::handleEvent() {
 	mReceivedEvent = event::GetEvent(mSubscriber.getEventBuffer());
+
+	if (mReceivedEvent->type() == event::EventType_ScheduleEvent
+			|| mReceivedEvent->type() == event::EventType_CancelEvent) {
+		this->handleRequest(mReceivedEvent);
+		return;
+	}
+
 	mEventName = mSubscriber.getEventName();
 	mCurrentSimTime = mReceivedEvent->timestamp();
 
 	if (mEventName == "SimTimeChanged") {
-
-		if (!mEventSet.empty()) {
-			auto nextEvent = mEventSet.back();
-
-			if (mCurrentSimTime >= nextEvent.getTimestamp()) {
-				nextEvent.setCurrentSimTime(mCurrentSimTime);
-				mFbb.Finish(
-						event::CreateEvent(mFbb,
-								mFbb.CreateString(nextEvent.getName()),
-								nextEvent.getTimestamp(),
-								event::Priority_NORMAL_PRIORITY,
-								nextEvent.getRepeat(), nextEvent.getPeriod(),
-								event::EventData_Flit,
-								event::CreateFlit(mFbb, nextEvent.getData()).Union()));
-
-				mPublisher.publishEvent(nextEvent.getName(),
-						mFbb.GetBufferPointer(), mFbb.GetSize());
-				this->updateEvents();
+		// The simulation model can grant several steps at once (time window)
+		uint64_t windowStart = mReceivedEvent->timestamp();
+		uint32_t timeStep = mReceivedEvent->period();
+		uint32_t numOfSteps = std::max<uint32_t>(mReceivedEvent->repeat(), 1);
+
+		// Requests, which were sent in the previous window, can arrive
+		// after the clock event (received on the high-priority lane).
+		// Dropped (invalid) events do not stop the draining.
+		while (mSubscriber.hasPendingEvent()) {
+			if (mSubscriber.receivePendingEvent()) {
+				this->handleRequest(
+						event::GetEvent(mSubscriber.getEventBuffer()));
 			}
 		}
-	}
 
-	else if (mEventName == "SaveState") {
-		this->saveState(mReceivedEvent->data_as_String()->str() + mName + ".config");
+		for (uint32_t step = 0; step < numOfSteps; step++) {
+			mCurrentSimTime = windowStart + step * timeStep;
+			this->simulateStep();
+		}
+		mPublisher.flushEvents();
+
+		// Acknowledge the finished step (simulation model waits for all models)
+		if (mClockMode != ClockMode::RealTime) {
+			// The next scheduled event defines the next activity of the queue
+			mStepReporter.reportStepDone(getNextActivityTime());
+		}
 	}
 
-	else if (mEventName == "LoadState") {
-		this->loadState(mReceivedEvent->data_as_String()->str() + mName + ".config");
+	else if (mEventName == "SaveState" || mEventName == "ExportState"
+			|| mEventName == "LoadState") {
+		std::string configPath;
+		if (!getStatePath(mReceivedEvent, configPath)) {
+			std::cout << mName << ": " << mEventName << " without a state path"
+					<< std::endl;
+		} else if (mEventName == "ExportState") {
+			this->storeState(configPath + mName + ".config", StateFormat::Xml);
+		} else if (mEventName == "LoadState") {
+			this->loadState(configPath + mName + ".config");
+		} else if (mSavepointMode == SavepointMode::Async) {
+			this->snapshotState(configPath + mName + ".config",
+					mReceivedEvent->timestamp());
+		} else {
+			this->saveState(configPath + mName + ".config");
+		}
 	}
 
 	else if (mEventName == "End") {
 		std::cout << "Queue: End-Event" << std::endl;
+		std::cout << mName << ": " << mNumOfLateEvents
+				<< " late events (total lateness: " << mTotalLateness
+				<< ", max. lateness: " << mMaxLateness << ")" << std::endl;
 		mRun = false;
 	}
 
 }
 
 void Queue::saveState(std::string filePath) {
-	// Store states
-	std::ofstream ofs(filePath);
-	boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
+	this->storeState(filePath, mStateFormat);
+}
 
+void Queue::storeState(std::string filePath, StateFormat format) {
+	// Store states
 	try {
-		oa << boost::serialization::make_nvp("EventSet", *this);
+		saveStateArchive(filePath, format, "EventSet", *this, &mDeltaBase);
 
 	} catch (boost::archive::archive_exception& ex) {
 		std::cout << mName << ": Archive Exception during serializing: "
@@ -156,13 +328,24 @@ void Queue::saveState(std::string filePath) {
 	mRun = mSubscriber.synchronizeSub();
 }
 
-void Queue::loadState(std::string filePath) {
-	// Restore states
-	std::ifstream ifs(filePath);
-	boost::archive::xml_iarchive ia(ifs, boost::archive::no_header);
+void Queue::snapshotState(std::string filePath, uint64_t savepointTime) {
+	// Only the snapshot is taken here, the simulation continues
+	// while the state writer stores it (no synchronization)
+	try {
+		mStateWriter.writeState(filePath, getStateImage("EventSet", *this),
+				mStateFormat, savepointTime);
 
+	} catch (boost::archive::archive_exception& ex) {
+		std::cout << mName << ": Archive Exception during serializing: "
+				<< std::endl;
+		throw ex.what();
+	}
+}
+
+void Queue::loadState(std::string filePath) {
+	// Restore states (binary or XML)
 	try {
-		ia >> boost::serialization::make_nvp("EventSet", *this);
+		loadStateArchive(filePath, "EventSet", *this);
 
 	} catch (boost::archive::archive_exception& ex) {
 		std::cout << mName << ": Archive Exception during deserializing: "
@@ -170,9 +353,11 @@ void Queue::loadState(std::string filePath) {
 		throw ex.what();
 	}
 
-	mScheduler.scheduleEvents(mEventSet);
-
 	mRun = mSubscriber.synchronizeSub();
 
-	this->init();
+	// A savepoint contains the initial events already (the state replaces the
+	// queue), so they are only scheduled, if the state was not initialized
+	if (!mInitialized) {
+		this->init();
+	}
 }
@@ -17,19 +17,27 @@
 #include <fstream>
 #include <functional>
 #include <boost/serialization/vector.hpp>
-#include <boost/archive/xml_iarchive.hpp>
-#include <boost/archive/xml_oarchive.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 #include <zmq.hpp>
 
 #include "communication/Dealer.h"
-#include "communication/Publisher.h"
-#include "communication/Subscriber.h"
+#include "common/communication/EventPublisher.h"
+#include "common/communication/EventSubscriber.h"
+#include "common/communication/EventVerifier.h"
+#include "common/communication/EventPayload.h"
+#include "common/communication/LinkTopics.h"
+#include "common/communication/StepReporter.h"
 #include "data-types/EventSet.h"
+#include "common/scheduler/EventHeap.h"
+#include "common/scheduler/TimingWheel.h"
 #include "communication/zhelpers.hpp"
 #include "interfaces/IModel.h"
 #include "interfaces/IPersist.h"
 #include "interfaces/IQueue.h"
-#include "scheduler/Scheduler.h"
+#include "common/data-types/ClockMode.h"
+#include "common/persistence/StateArchive.h"
+#include "common/persistence/StateWriter.h"
 
 #include "resources/idl/event_generated.h"
 
@@ -38,7 +46,7 @@ class Queue: public virtual IModel,
 		public virtual IQueue {
 
 public:
-	Queue(std::string name, std::string description);
+	Queue(zmq::context_t &ctx, std::string name, std::string description);
 	virtual ~Queue();
 
 	// IModel
@@ -58,38 +66,94 @@ public:
 
 private:
 	void handleEvent();
+	void handleRequest(const event::Event* request);
+	void simulateStep();
 
 	// IQueue
 	virtual void updateEvents() override;
-	EventSet mEventSet;
+	void scheduleEvent(const Event &event);
+	uint64_t getNextActivityTime() const;
+
+	// Future events, the next event is on top
+	EventHeap<Event> mEventQueue;
+	// Periodic events within the horizon of the wheel
+	TimingWheel<Event> mPeriodicEvents;
+	// Events which are published in the current step
+	std::vector<Event> mDueEvents;
+
+	// Events published after their timestamp and their delay (in sim time)
+	uint64_t mNumOfLateEvents = 0;
+	uint64_t mTotalLateness = 0;
+	uint64_t mMaxLateness = 0;
 
 	std::string mName;
 	std::string mDescription;
 
+	// The initial events were scheduled (see init), also if all of them are
+	// released already
+	bool mInitialized = false;
+
 	friend class boost::serialization::access;
 	template<typename Archive>
-	void serialize(Archive& archive, const unsigned int) {
-		for (auto event : mEventSet) {
-			archive & boost::serialization::make_nvp("Event", event);
+	void save(Archive& archive, const unsigned int) const {
+		archive << boost::serialization::make_nvp("Initialized", mInitialized);
+		std::vector<Event> events = mEventQueue.getEvents();
+		std::vector<Event> periodicEvents = mPeriodicEvents.getEvents();
+		events.insert(events.end(), periodicEvents.begin(),
+				periodicEvents.end());
+		std::stable_sort(events.begin(), events.end(),
+				[](const Event &a, const Event &b) {
+					return a.getTimestamp() < b.getTimestamp();
+				});
+		archive << boost::serialization::make_nvp("Events", events);
+	}
+	template<typename Archive>
+	void load(Archive& archive, const unsigned int version) {
+		if (version >= 1) {
+			archive >> boost::serialization::make_nvp("Initialized", mInitialized);
+		}
+		std::vector<Event> events;
+		archive >> boost::serialization::make_nvp("Events", events);
+		mEventQueue.clear();
+		mPeriodicEvents.clear();
+		for (auto &event : events) {
+			scheduleEvent(event);
+		}
+
+		// Files without the flag: Only a queue with events was initialized
+		if (version == 0) {
+			mInitialized = !events.empty();
 		}
 	}
+	BOOST_SERIALIZATION_SPLIT_MEMBER()
 
 	// Subscriber & Publisher
-	zmq::context_t mCtx;
-	Subscriber mSubscriber;
-	Publisher mPublisher;
+	zmq::context_t &mCtx;
+	EventSubscriber mSubscriber;
+	EventPublisher mPublisher;
 	Dealer mDealer;
+	StepReporter mStepReporter;
 
 	bool mRun;
 	const event::Event* mReceivedEvent;
 	std::string mEventName;
 	std::string mData;
 
-	Scheduler mScheduler;
 	uint64_t mCurrentSimTime;
+	ClockMode mClockMode = ClockMode::RealTime;
+	StateFormat mStateFormat = StateFormat::Xml;
+	// Last full savepoint (delta format)
+	DeltaBase mDeltaBase;
+	void storeState(std::string filePath, StateFormat format);
+	SavepointMode mSavepointMode = SavepointMode::Sync;
+	StateWriter mStateWriter;
+	void snapshotState(std::string filePath, uint64_t savepointTime);
 
 	// Serialization
 	flatbuffers::FlatBufferBuilder mFbb;
 };
 
+// Files without a version do not contain the Initialized flag
+BOOST_CLASS_VERSION(Queue, 1)
+
 #endif /* EVENT_QUEUE_1_QUEUE_H_ */
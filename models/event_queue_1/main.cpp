@@ -18,7 +18,9 @@
 #include "Queue.h"
 
 int main() {
-	Queue eventQueue("event_queue_1", "Queue includes the scheduled events.");
+	zmq::context_t ctx(1);
+	Queue eventQueue(ctx, "event_queue_1",
+			"Queue includes the scheduled events.");
 	try {
 		eventQueue.run();
 
@@ -12,20 +12,28 @@
  */
 
 #include <vector>
+#include <algorithm>
 #include <cstdint>
 #include <bitset>
 #include "ProcessingElement.h"
 
 #define NOC_NODE_COUNT 4
-
-ProcessingElement::ProcessingElement(std::string name, std::string description) :
-		mName(name), mDescription(description), mCtx(1), mSubscriber(mCtx), mPublisher(
-				mCtx), mDealer(mCtx, mName), mCurrentSimTime(0), mPacketGenerator(), mPacketSink(), mPacketNumber(
+// Max. number of steps the packet generator is queried in advance (next-event mode)
+#define GENERATOR_LOOKAHEAD 1000
+// Type of the last flit of a packet (Bonfire flit format)
+#define TAIL_FLIT_TYPE 0x4
+
+ProcessingElement::ProcessingElement(zmq::context_t &ctx, std::string name,
+		std::string description) :
+		mName(name), mDescription(description), mCtx(ctx), mSubscriber(mCtx), mPublisher(
+				mCtx), mDealer(mCtx, mName), mStepReporter(mCtx), mEventDispatcher(
+				this), mCurrentSimTime(0), mStateWriter(mCtx), mPacketGenerator(), mPacketSink(), mPacketNumber(
 				"PacketNumber", 10), mMinPacketLength("minPacketLength", 3), mMaxPacketLength(
 				"maxPacketLength", 10), mRandomSeed("randomSeed", 42), mPacketsToGenerate(
 				"packetsToGenerate", 3), mPir("PIR", 0.05) {
 
 	registerInterruptSignal();
+	this->registerEventHandlers();
 
 	mRun = this->prepare();
 	//init();
@@ -36,51 +44,136 @@ ProcessingElement::~ProcessingElement() {
 
 void ProcessingElement::init() {
 	// Set or calculate other parameters ...
+	// (the traffic models are initialized when the state is loaded)
+	uint16_t destinationAddress = 1;
+	if (destinationAddress == mAddress) {
+		destinationAddress = 2;
+	}
+}
+
+void ProcessingElement::initTrafficModels() {
 	mPacketGenerator.init(mAddress, NOC_NODE_COUNT, GenerationModes::random,
 			mPir.getValue(), mMinPacketLength.getValue(),
 			mMaxPacketLength.getValue(), mRandomSeed.getValue(),
 			mPacketsToGenerate.getValue());
+	mNumOfGeneratorQueries = 0;
 
 	mPacketSink.init(mAddress);
+	mSinkPacketFlits.clear();
+	mNumOfReceivedPackets = 0;
+}
 
-	uint16_t destinationAddress = 1;
-	if (destinationAddress == mAddress) {
-		destinationAddress = 2;
+void ProcessingElement::replayPacketGenerator(uint64_t numOfQueries) {
+	while (mNumOfGeneratorQueries < numOfQueries) {
+		mPacketGenerator.getFlit();
+		mNumOfGeneratorQueries++;
+	}
+}
+
+void ProcessingElement::restorePacketSink() {
+	if (mNumOfReceivedPackets > 0) {
+		throw MissingCoreState(
+				"the packet sink cannot restore its "
+						+ std::to_string(mNumOfReceivedPackets)
+						+ " received packets");
+	}
+
+	// The sink continues the packet, which it received at the savepoint
+	for (auto flit : mSinkPacketFlits) {
+		mPacketSink.putFlit(flit);
 	}
 }
 
 bool ProcessingElement::prepare() {
 	mSubscriber.setOwnershipName(mName);
-
-	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName))) {
+	// Events of other hosts are verified before they are accessed
+	mSubscriber.setEventVerifier(
+			&verifyEventBuffer<event::VerifyEventBuffer>);
+	mClockMode = toClockMode(
+			mDealer.getModelParameter("simulation_model", "clockMode"));
+	mStateFormat = toStateFormat(
+			mDealer.getModelParameter("simulation_model", "stateFormat"));
+	mSavepointMode = toSavepointMode(
+			mDealer.getModelParameter("simulation_model", "savepointMode"));
+
+	if (!mPublisher.bindSocket(
+			mDealer.getModelParameter(mName, "bindEndpoints"))) {
 		return false;
 	}
 
 	// Connect to simulation model (global clock) to receive the current simulation time
-	if (!mSubscriber.connectToPub(mDealer.getIPFrom("simulation_model"),
-			mDealer.getPortNumFrom("simulation_model"))) {
+	// (or to the clock relay of the host, if defined)
+	std::string clockSource = mDealer.getModelParameter(mName, "clockSource");
+	if (clockSource.empty()) {
+		clockSource = "simulation_model";
+	}
+
+	// Events of the clock source are received on the high-priority lane
+	if (!mSubscriber.connectToControlPub(
+			mDealer.getModelParameter(clockSource, "endpoint"))) {
+		return false;
+	}
+
+	if (!mStepReporter.connectToCollector(
+			mDealer.getModelParameter(clockSource, "stepEndpoint"))) {
+		return false;
+	}
+
+	// Asynchronous savepoints are reported as durable by the state writer
+	if (mSavepointMode == SavepointMode::Async
+			&& !mStateWriter.connectToCollector(
+					mDealer.getModelParameter(clockSource, "stepEndpoint"))) {
 		return false;
 	}
 
-	// Connect to all models (in this case the corresponding router) it depends on
+	// Optional traffic report, which is scheduled in the event queue
+	mEventQueue = mDealer.getModelParameter(mName, "eventQueue");
+	std::string reportInterval = mDealer.getModelParameter(mName,
+			"reportInterval");
+	if (!mEventQueue.empty() && !reportInterval.empty()) {
+		mReportInterval = std::stoull(reportInterval);
+		mScheduleTopic = EventTopic(getScheduleTopic(mEventQueue));
+	}
+
+	// Connect to all models (the corresponding router and the event queue) it depends on
 	for (auto depModel : mDealer.getModelDependencies()) {
-		if (!mSubscriber.connectToPub(mDealer.getIPFrom(depModel),
-				mDealer.getPortNumFrom(depModel))) {
+		if (!mSubscriber.connectToPub(
+				mDealer.getModelParameter(depModel, "endpoint"))) {
 			return false;
 		}
 
+		// The queue releases the scheduled events (see LinkTopics.h)
+		if (depModel == mEventQueue) {
+			continue;
+		}
+
+		// Links with a latency are synchronized conservatively
+		std::string latency = mDealer.getModelParameter(mName,
+				depModel + "_latency");
+		if (mClockMode == ClockMode::Conservative && !latency.empty()) {
+			if (!mSynchronizer.addInputChannel(depModel, std::stoull(latency))) {
+				return false;
+			}
+		}
+
 		// Set processing element address (router address)
 		mAddress = static_cast<uint16_t>(std::bitset<16>(
 				mDealer.getModelParameter(depModel, "address")).to_ulong());
+		mRouterLinkTopic = EventTopic(
+				getLinkTopic(depModel, "PacketGenerator"));
 	}
 
-	mSubscriber.subscribeTo("Local");
-	mSubscriber.subscribeTo("Credit_in_L++");
+	mSubscriber.subscribeToControl("SimTimeChanged");
+	mSubscriber.subscribeToControl("LoadState");
+	mSubscriber.subscribeToControl("SaveState");
+	mSubscriber.subscribeToControl("ExportState");
+	mSubscriber.subscribeToControl("End");
 
-	mSubscriber.subscribeTo("SimTimeChanged");
-	mSubscriber.subscribeTo("LoadState");
-	mSubscriber.subscribeTo("SaveState");
-	mSubscriber.subscribeTo("End");
+	// Flits and credits of the router (see LinkTopics.h)
+	mSubscriber.subscribeTo(getLinkPrefix(mName));
+	if (mClockMode == ClockMode::Conservative) {
+		mSubscriber.subscribeTo("Null");
+	}
 
 	// Synchronization
 	if (!mSubscriber.prepareSubSynchronization(
@@ -104,96 +197,379 @@ void ProcessingElement::run() {
 	}
 }
 
+void ProcessingElement::registerEventHandlers() {
+	mEventDispatcher.registerHandler(event::EventType_SimTimeChanged,
+			&ProcessingElement::handleSimTimeChanged);
+	mEventDispatcher.registerHandler(event::EventType_End,
+			&ProcessingElement::handleEnd);
+	mEventDispatcher.registerHandler(event::EventType_SaveState,
+			&ProcessingElement::handleSaveState);
+	mEventDispatcher.registerHandler(event::EventType_LoadState,
+			&ProcessingElement::handleLoadState);
+	mEventDispatcher.registerHandler(event::EventType_ExportState,
+			&ProcessingElement::handleExportState);
+	mEventDispatcher.registerHandler(event::EventType_Local,
+			&ProcessingElement::handleFlit);
+	mEventDispatcher.registerHandler(event::EventType_Credit_in_L,
+			&ProcessingElement::handleCredit);
+	mEventDispatcher.registerHandler(event::EventType_TimedEvent,
+			&ProcessingElement::handleTimedEvent);
+}
+
 void ProcessingElement::handleEvent() {
 	auto eventBuffer = mSubscriber.getEventBuffer();
 
 	auto receivedEvent = event::GetEvent(eventBuffer);
-	std::string eventName = receivedEvent->name()->str();
+
+	// Events of the neighbours, which were sent before the clock event or
+	// the savepoint request, can arrive after it (high-priority lane)
+	if (receivedEvent->type() == event::EventType_SimTimeChanged
+			|| receivedEvent->type() == event::EventType_SaveState
+			|| receivedEvent->type() == event::EventType_ExportState) {
+		this->receivePendingEvents();
+	}
+
+	// Conservative synchronization: Events of the router are
+	// delivered in the step after the link latency
+	if (mClockMode == ClockMode::Conservative
+			&& receivedEvent->source() != nullptr
+			&& mSynchronizer.isInputChannel(receivedEvent->source()->c_str())) {
+		this->handleNeighbourEvent(receivedEvent);
+		return;
+	}
+
 	mCurrentSimTime = receivedEvent->timestamp();
 	mRun = !foundCriticalSimCycle(mCurrentSimTime);
 
-	if (receivedEvent->event_data() != nullptr) {
-		auto dataRef = receivedEvent->event_data_flexbuffer_root();
+	mEventDispatcher.dispatch(receivedEvent);
+}
 
-		if (dataRef.IsUInt()) {
-			auto flitData =
-					receivedEvent->event_data_flexbuffer_root().AsUInt32();
+void ProcessingElement::receivePendingEvents() {
+	// Dropped (invalid) events do not stop the draining. The received
+	// control event stays valid (buffer of its lane).
+	while (mSubscriber.hasPendingEvent()) {
+		if (mSubscriber.receivePendingEvent()) {
+			this->handleEvent();
+		}
+	}
+}
 
-			if (eventName == "Local") {
-				mPacketSink.putFlit(flitData);
-			}
+void ProcessingElement::handleSimTimeChanged(
+		const event::Event* receivedEvent) {
+	// The simulation model can grant several steps at once (time window)
+	uint32_t numOfSteps = std::max<uint32_t>(receivedEvent->repeat(), 1);
+
+	if (mReportInterval > 0 && mNextReportTime == NO_ACTIVITY) {
+		this->scheduleReports(receivedEvent->timestamp());
+	}
+
+	if (mClockMode == ClockMode::Conservative) {
+		// The neighbours may only simulate the steps of the window after
+		// they know, that this model sends no earlier events
+		if (mSynchronizer.grantWindow(receivedEvent->timestamp(), numOfSteps,
+				receivedEvent->period())) {
+			this->sendNullMessage(receivedEvent->timestamp());
+			mPublisher.flushEvents();
 		}
+		mTimeStep = receivedEvent->period();
+		this->simulateSafeSteps();
+		return;
+	}
 
-		else if (dataRef.IsString()) {
-			std::string configPath =
-					receivedEvent->event_data_flexbuffer_root().AsString().str();
+	for (uint32_t step = 0; step < numOfSteps; step++) {
+		mCurrentSimTime = receivedEvent->timestamp()
+				+ step * receivedEvent->period();
+		simulateStep(receivedEvent->period());
+	}
 
-			if (eventName == "SaveState") {
-				saveState(
-						std::string(configPath.begin(), configPath.end())
-								+ mName + ".config");
-			}
+	// The flits of this cycle are sent together
+	this->sendBurst();
+	mPublisher.flushEvents();
 
-			else if (eventName == "LoadState") {
-				loadState(
-						std::string(configPath.begin(), configPath.end())
-								+ mName + ".config");
-			}
+	// Acknowledge the finished step (simulation model waits for all models)
+	if (mClockMode != ClockMode::RealTime) {
+		this->updateNextReportTime();
+		mStepReporter.reportStepDone(getNextActivityTime());
+	}
+}
+
+void ProcessingElement::handleEnd(const event::Event*) {
+	mRun = false;
+}
+
+void ProcessingElement::handleSaveState(const event::Event* receivedEvent) {
+	std::string configPath;
+	if (!getStatePath(receivedEvent, configPath)) {
+		std::cout << mName << ": SaveState without a state path" << std::endl;
+		return;
+	}
+	if (mSavepointMode == SavepointMode::Async) {
+		snapshotState(configPath + mName + ".config",
+				receivedEvent->timestamp());
+	} else {
+		saveState(configPath + mName + ".config");
+	}
+}
+
+void ProcessingElement::handleLoadState(const event::Event* receivedEvent) {
+	std::string configPath;
+	if (!getStatePath(receivedEvent, configPath)) {
+		std::cout << mName << ": LoadState without a state path" << std::endl;
+		return;
+	}
+	loadState(configPath + mName + ".config");
+}
+
+void ProcessingElement::handleExportState(
+		const event::Event* receivedEvent) {
+	std::string configPath;
+	if (!getStatePath(receivedEvent, configPath)) {
+		std::cout << mName << ": ExportState without a state path" << std::endl;
+		return;
+	}
+	storeState(configPath + mName + ".config", StateFormat::Xml);
+}
+
+void ProcessingElement::handleFlit(const event::Event* receivedEvent) {
+	uint32_t flit = 0;
+	if (getFlit(receivedEvent, flit)) {
+		this->receiveFlit(receivedEvent->type(), flit);
+	}
+}
+
+void ProcessingElement::handleCredit(const event::Event* receivedEvent) {
+	this->receiveCredit(receivedEvent->type(), getCreditCount(receivedEvent));
+}
+
+void ProcessingElement::handleTimedEvent(const event::Event* receivedEvent) {
+	if (receivedEvent->name() == nullptr
+			|| receivedEvent->name()->str() != getLinkTopic(mName, "Report")) {
+		return;
+	}
+
+	std::cout << "\e[1mT=" << receivedEvent->timestamp() << ": \e[0m" << mName
+			<< " sent " << mNumOfSentFlits << " flits and received "
+			<< mNumOfReceivedPackets << " packets" << std::endl;
+}
+
+void ProcessingElement::scheduleReports(uint64_t simTime) {
+	mNextReportTime = simTime + mReportInterval;
+
+	// The queue releases the report periodically (repeat -1: until the end)
+	auto &fbb = mEventEncoder.startEvent();
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb,
+					fbb.CreateString(getLinkTopic(mName, "Report")),
+					mNextReportTime, event::Priority_NORMAL_PRIORITY,
+					static_cast<uint32_t>(-1),
+					static_cast<uint32_t>(mReportInterval),
+					event::EventData_NONE, 0, fbb.CreateString(mName),
+					event::EventType_ScheduleEvent));
+
+	mPublisher.queueEvent(mScheduleTopic, mEventEncoder);
+}
+
+void ProcessingElement::updateNextReportTime() {
+	// The queue releases the report in the step of its timestamp and
+	// schedules it again one interval later
+	while (mNextReportTime != NO_ACTIVITY
+			&& mNextReportTime <= uint64_t(mCurrentSimTime)) {
+		mNextReportTime += mReportInterval;
+	}
+}
+
+void ProcessingElement::receiveFlit(event::EventType eventType,
+		uint32_t flitData) {
+	if (eventType == event::EventType_Local) {
+		mPacketSink.putFlit(flitData);
+
+		// The flit type is stored in the three most significant bits
+		mSinkPacketFlits.push_back(flitData);
+		if ((flitData >> 29) == TAIL_FLIT_TYPE) {
+			mSinkPacketFlits.clear();
+			mNumOfReceivedPackets++;
+		}
+	}
+}
+
+void ProcessingElement::receiveCredit(event::EventType eventType,
+		uint32_t count) {
+	if (eventType == event::EventType_Credit_in_L) {
+		mCredit_Cnt_L = std::min<uint32_t>(mCredit_Cnt_L + count, 3);
+	}
+}
+
+void ProcessingElement::handleNeighbourEvent(
+		const event::Event* receivedEvent) {
+	const char *source = receivedEvent->source()->c_str();
+
+	if (receivedEvent->type() == event::EventType_Null) {
+		mSynchronizer.updateChannelTime(source, receivedEvent->timestamp());
+	} else {
+		// The data of a deferred credit is the number of credits
+		uint32_t data = 0;
+		bool isFlit = getFlit(receivedEvent, data);
+		if (!isFlit) {
+			data = getCreditCount(receivedEvent);
 		}
 
+		mSynchronizer.deferEvent(source, receivedEvent->timestamp(),
+				receivedEvent->type(), data, isFlit);
 	}
 
-	else if (eventName == "SimTimeChanged") {
+	this->simulateSafeSteps();
+}
+
+void ProcessingElement::simulateSafeSteps() {
+	bool stepSimulated = false;
+
+	while (mSynchronizer.canSimulateNextStep()) {
+		mCurrentSimTime = mSynchronizer.getNextStepTime();
+
+		// Deliver the events of the router, which arrive in this step
+		DeferredEvent deferredEvent;
+		while (mSynchronizer.popDueEvent(mCurrentSimTime, deferredEvent)) {
+			auto eventType = static_cast<event::EventType>(deferredEvent.type);
+			if (deferredEvent.hasData) {
+				this->receiveFlit(eventType, deferredEvent.data);
+			} else {
+				this->receiveCredit(eventType, deferredEvent.data);
+			}
+		}
+
+		// The router delivers the flits in the step after their timestamp,
+		// so the burst of a safe step contains the flit of this step only
+		simulateStep(mTimeStep);
+		this->sendBurst();
+		mSynchronizer.finishStep();
+		stepSimulated = true;
+	}
 
-		if (mCredit_Cnt_L > 0) {
+	// Null message: No events will be sent before the next step
+	// (sent after the flits of the cycle)
+	if (stepSimulated) {
+		this->sendNullMessage(mSynchronizer.getNextStepTime());
+		mPublisher.flushEvents();
+	}
 
-			uint32_t flit = mPacketGenerator.getFlit();
+	if (mSynchronizer.finishWindow()) {
+		this->updateNextReportTime();
+		mStepReporter.reportStepDone(getNextActivityTime());
+	}
+}
 
-			if (flit != 0) {
+void ProcessingElement::sendNullMessage(uint64_t nextStepTime) {
+	auto &fbb = mEventEncoder.startEvent();
 
-				// Event Serialization
-				flatbuffers::FlatBufferBuilder fbb;
-				flatbuffers::Offset<event::Event> eventOffset;
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("Null"), nextStepTime,
+					event::Priority_NORMAL_PRIORITY, 0, 0, event::EventData_NONE,
+					0, fbb.CreateString(mName), event::EventType_Null));
 
-				// Event Data Serialization
-				flexbuffers::Builder flexbuild;
-				flexbuild.Add(flit);
-				flexbuild.Finish();
-				auto data = fbb.CreateVector(flexbuild.GetBuffer());
+	mPublisher.queueEvent(mNullTopic, mEventEncoder);
+}
 
-				// Sending (Publishing) a flit and using Flatbuffers to serialize the data (flit):
-				std::string eventName = "PacketGenerator";
-				eventOffset = event::CreateEvent(fbb,
-						fbb.CreateString(eventName), mCurrentSimTime,
-						event::Priority_NORMAL_PRIORITY, 0, 0, data);
-				fbb.Finish(eventOffset);
+void ProcessingElement::simulateStep(uint32_t timeStep) {
+	if (mCredit_Cnt_L > 0) {
 
-				std::cout << "\e[1mT=" << mCurrentSimTime << ": \e[0m" << mName
-						<< " sends " << flit << std::endl;
+		if (mNextFlit == 0) {
+			queryPacketGenerator(timeStep);
+		}
 
-				mPublisher.publishEvent(eventName, fbb.GetBufferPointer(),
-						fbb.GetSize());
+		if (mNextFlit != 0 && mNextFlitTime <= mCurrentSimTime) {
+			std::cout << "\e[1mT=" << mCurrentSimTime << ": \e[0m" << mName
+					<< " sends " << mNextFlit << std::endl;
 
-				mCredit_Cnt_L--;
+			// The flits of a time window are injected as one burst
+			if (mBurst.empty()) {
+				mBurstTime = mCurrentSimTime;
 			}
+			mBurst.push_back(mNextFlit);
+			mNextFlit = 0;
+
+			mCredit_Cnt_L--;
+			mNumOfSentFlits++;
 		}
 	}
+}
+
+void ProcessingElement::sendBurst() {
+	if (mBurst.empty()) {
+		return;
+	}
 
-	else if (eventName == "Credit_in_L++") {
-		if (mCredit_Cnt_L < 3) {
-			mCredit_Cnt_L++;
+	// Event Serialization (reuses the memory of the previous event)
+	auto &fbb = mEventEncoder.startEvent();
+
+	// A single flit is sent with the fixed-size payload
+	auto dataType = event::EventData_Flit;
+	flatbuffers::Offset<void> data;
+	if (mBurst.size() == 1) {
+		data = fbb.CreateStruct(event::Flit(mBurst.front())).Union();
+	} else {
+		dataType = event::EventData_Flits;
+		data = event::CreateFlits(fbb, fbb.CreateVector(mBurst)).Union();
+	}
+
+	// Sending (Publishing) the flits and using Flatbuffers to serialize the data (flits):
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("PacketGenerator"),
+					mBurstTime, event::Priority_NORMAL_PRIORITY, 0, 0,
+					dataType, data, fbb.CreateString(mName),
+					event::EventType_PacketGenerator));
+
+	mPublisher.queueEvent(mRouterLinkTopic, mEventEncoder);
+	mBurst.clear();
+}
+
+void ProcessingElement::queryPacketGenerator(uint32_t timeStep) {
+	// The packet generator is queried once per step (as long as credits are available).
+	// In next-event mode it is queried in advance for the following steps,
+	// so that the time of the next flit is known and idle steps can be skipped.
+	uint32_t lookahead =
+			(mClockMode == ClockMode::NextEvent) ? GENERATOR_LOOKAHEAD : 1;
+	uint64_t generatorTime = std::max<uint64_t>(mCurrentSimTime,
+			mNextGeneratorTime);
+
+	for (uint32_t step = 0; step < lookahead; step++) {
+		uint32_t flit = mPacketGenerator.getFlit();
+		mNumOfGeneratorQueries++;
+		mNextGeneratorTime = generatorTime + timeStep;
+
+		if (flit != 0) {
+			mNextFlit = flit;
+			mNextFlitTime = generatorTime;
+			break;
 		}
-	} else if (eventName == "End") {
-		mRun = false;
+
+		generatorTime += timeStep;
 	}
 }
 
+uint64_t ProcessingElement::getNextActivityTime() const {
+	// The clock must not skip the next report (see LinkTopics.h)
+	uint64_t nextReportTime = mNextReportTime;
+
+	// Without credits, the PE wakes up again if it receives a credit from the router
+	if (mCredit_Cnt_L == 0) {
+		return nextReportTime;
+	}
+
+	if (mNextFlit != 0) {
+		return std::min(mNextFlitTime, nextReportTime);
+	}
+
+	return std::min(mNextGeneratorTime, nextReportTime);
+}
+
 void ProcessingElement::saveState(std::string filePath) {
+	storeState(filePath, mStateFormat);
+}
+
+void ProcessingElement::storeState(std::string filePath, StateFormat format) {
 	// Store states
-	std::ofstream ofs(filePath);
-	boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
 	try {
-		oa << boost::serialization::make_nvp("FieldSet", *this);
+		saveStateArchive(filePath, format, "FieldSet", *this, &mDeltaBase);
 
 	} catch (boost::archive::archive_exception& ex) {
 		std::cout << mName << ": Archive Exception during serializing:"
@@ -204,21 +580,39 @@ void ProcessingElement::saveState(std::string filePath) {
 	mRun = mSubscriber.synchronizeSub();
 }
 
+void ProcessingElement::snapshotState(std::string filePath,
+		uint64_t savepointTime) {
+	// Only the snapshot is taken here, the simulation continues
+	// while the state writer stores it (no synchronization)
+	try {
+		mStateWriter.writeState(filePath, getStateImage("FieldSet", *this),
+				mStateFormat, savepointTime);
+
+	} catch (boost::archive::archive_exception& ex) {
+		std::cout << mName << ": Archive Exception during serializing:"
+				<< std::endl;
+		std::cout << ex.what() << std::endl;
+	}
+}
+
 void ProcessingElement::loadState(std::string filePath) {
-	// Restore states
-	std::ifstream ifs(filePath);
-	boost::archive::xml_iarchive ia(ifs, boost::archive::no_header);
+	bool restored = true;
+	// Restore states (binary or XML)
 	try {
-		ia >> boost::serialization::make_nvp("FieldSet", *this);
+		loadStateArchive(filePath, "FieldSet", *this);
 
 	} catch (boost::archive::archive_exception& ex) {
 		std::cout << mName << ":Archive Exception during deserializing:"
 				<< std::endl;
 		std::cout << ex.what() << std::endl;
+	} catch (MissingCoreState& ex) {
+		std::cout << mName << ": The state cannot be restored exactly, "
+				<< ex.what() << ". The model stops." << std::endl;
+		restored = false;
 	}
 
 	// Optional calculate parameters from the loaded initial state
 	init();
 
-	mRun = mSubscriber.synchronizeSub();
+	mRun = mSubscriber.synchronizeSub() && restored;
 }
@@ -16,19 +16,32 @@
 
 #include <fstream>
 #include <boost/serialization/serialization.hpp>
-#include <boost/archive/xml_oarchive.hpp>
-#include <boost/archive/xml_iarchive.hpp>
+#include <boost/serialization/version.hpp>
+#include <boost/serialization/vector.hpp>
 #include <zmq.hpp>
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 #include "communication/zhelpers.hpp"
-#include "communication/Subscriber.h"
-#include "communication/Publisher.h"
+#include "common/communication/EventSubscriber.h"
+#include "common/communication/EventVerifier.h"
+#include "common/communication/EventPublisher.h"
+#include "common/communication/EventEncoder.h"
+#include "common/communication/EventTopic.h"
+#include "common/communication/EventPayload.h"
+#include "common/communication/LinkTopics.h"
 #include "communication/Dealer.h"
+#include "common/communication/StepReporter.h"
+#include "common/communication/EventDispatcher.h"
+#include "common/synchronization/ConservativeSynchronizer.h"
 #include "interfaces/IModel.h"
 #include "interfaces/IPersist.h"
 #include "data-types/Field.h"
+#include "common/data-types/ClockMode.h"
+#include "common/persistence/StateArchive.h"
+#include "common/persistence/StateWriter.h"
+#include "common/persistence/CoreState.h"
 
 #include "resources/idl/event_generated.h"
 #include "traffic_generator/packet_generator.h"
@@ -36,7 +49,8 @@
 
 class ProcessingElement: public virtual IModel, public virtual IPersist {
 public:
-	ProcessingElement(std::string name, std::string description);
+	ProcessingElement(zmq::context_t &ctx, std::string name,
+			std::string description);
 	virtual ~ProcessingElement();
 
 	// IModel
@@ -62,18 +76,89 @@ private:
 
 	// Subscriber
 	void handleEvent();
-	zmq::context_t mCtx;
-	Subscriber mSubscriber;
-	Publisher mPublisher;
+	// Receives the events of the neighbours, which are already pending
+	void receivePendingEvents();
+	void registerEventHandlers();
+	void handleSimTimeChanged(const event::Event* receivedEvent);
+	void handleEnd(const event::Event* receivedEvent);
+	void handleSaveState(const event::Event* receivedEvent);
+	void handleLoadState(const event::Event* receivedEvent);
+	void handleExportState(const event::Event* receivedEvent);
+	void handleFlit(const event::Event* receivedEvent);
+	void handleCredit(const event::Event* receivedEvent);
+	void handleTimedEvent(const event::Event* receivedEvent);
+	void receiveFlit(event::EventType eventType, uint32_t flitData);
+	void receiveCredit(event::EventType eventType, uint32_t count);
+	zmq::context_t &mCtx;
+	EventSubscriber mSubscriber;
+	EventPublisher mPublisher;
+	EventEncoder mEventEncoder;
 	Dealer mDealer;
+	StepReporter mStepReporter;
+	EventDispatcher<ProcessingElement, event::Event, event::EventType_MAX + 1> mEventDispatcher;
 
 	uint16_t mAddress = 0;
+	// Topic of the flits to the router (see LinkTopics.h)
+	EventTopic mRouterLinkTopic;
 	uint16_t mCredit_Cnt_L = 3;
 
+	// Next generated flit and the simulation time at which it is sent
+	uint32_t mNextFlit = 0;
+	uint64_t mNextFlitTime = 0;
+	// First simulation step for which the packet generator was not queried yet
+	uint64_t mNextGeneratorTime = 0;
+	// Flits which are injected in the current time window and the time of
+	// the first of them
+	std::vector<uint32_t> mBurst;
+	uint64_t mBurstTime = 0;
+	void simulateStep(uint32_t timeStep);
+	void sendBurst();
+	void queryPacketGenerator(uint32_t timeStep);
+	uint64_t getNextActivityTime() const;
+
+	// Traffic report, which the future event service of the queue releases
+	// periodically (parameters eventQueue and reportInterval)
+	std::string mEventQueue;
+	uint64_t mReportInterval = 0;
+	EventTopic mScheduleTopic;
+	// Time of the next report (NO_ACTIVITY, if it was not scheduled yet)
+	uint64_t mNextReportTime = NO_ACTIVITY;
+	uint64_t mNumOfSentFlits = 0;
+	void scheduleReports(uint64_t simTime);
+	void updateNextReportTime();
+
+	// Conservative synchronization with the router (null messages)
+	ConservativeSynchronizer mSynchronizer;
+	uint32_t mTimeStep = 0;
+	EventTopic mNullTopic { "Null" };
+	void handleNeighbourEvent(const event::Event* receivedEvent);
+	void simulateSafeSteps();
+	void sendNullMessage(uint64_t nextStepTime);
+
 	bool mRun;
 	int mCurrentSimTime;
+	ClockMode mClockMode = ClockMode::RealTime;
+	StateFormat mStateFormat = StateFormat::Xml;
+	// Last full savepoint (delta format)
+	DeltaBase mDeltaBase;
+	void storeState(std::string filePath, StateFormat format);
+	SavepointMode mSavepointMode = SavepointMode::Sync;
+	StateWriter mStateWriter;
+	void snapshotState(std::string filePath, uint64_t savepointTime);
 	PacketGenerator mPacketGenerator;
 	PacketSink mPacketSink;
+	// If the packet generator is not serializable (see CoreState.h), its
+	// state (random numbers) is restored by querying it again as often as
+	// before the savepoint
+	uint64_t mNumOfGeneratorQueries = 0;
+	void initTrafficModels();
+	void replayPacketGenerator(uint64_t numOfQueries);
+	// Flits of the packet, which the sink currently receives, and the number
+	// of completely received packets (state of a non-serializable sink, which
+	// can only be restored before the first packet was received)
+	std::vector<uint32_t> mSinkPacketFlits;
+	uint64_t mNumOfReceivedPackets = 0;
+	void restorePacketSink();
 	std::queue<uint32_t> mPacket;
 
 	// Fields
@@ -86,14 +171,50 @@ private:
 
 	friend class boost::serialization::access;
 	template<typename Archive>
-	void serialize(Archive& archive, const unsigned int) {
+	void serialize(Archive& archive, const unsigned int version) {
 		archive & boost::serialization::make_nvp("IntField", mPacketNumber);
 		archive & boost::serialization::make_nvp("IntField", mMinPacketLength);
 		archive & boost::serialization::make_nvp("IntField", mMaxPacketLength);
 		archive & boost::serialization::make_nvp("IntField", mRandomSeed);
 		archive & boost::serialization::make_nvp("IntField", mPacketsToGenerate);
 		archive & boost::serialization::make_nvp("DoubleField", mPir);
+
+		// The traffic models are initialized before their state is restored
+		if (Archive::is_loading::value) {
+			initTrafficModels();
+		}
+
+		// Dynamic state (version 1), e.g., of a savepoint after the warm-up
+		if (version >= 1) {
+			archive & boost::serialization::make_nvp("CurrentSimTime", mCurrentSimTime);
+			archive & boost::serialization::make_nvp("CreditCount", mCredit_Cnt_L);
+			archive & boost::serialization::make_nvp("NextFlit", mNextFlit);
+			archive & boost::serialization::make_nvp("NextFlitTime", mNextFlitTime);
+			archive & boost::serialization::make_nvp("NextGeneratorTime", mNextGeneratorTime);
+			archive & boost::serialization::make_nvp("Synchronizer", mSynchronizer);
+			archive & boost::serialization::make_nvp("NextReportTime", mNextReportTime);
+			archive & boost::serialization::make_nvp("NumOfSentFlits", mNumOfSentFlits);
+
+			archive & boost::serialization::make_nvp("SinkPacketFlits", mSinkPacketFlits);
+			archive & boost::serialization::make_nvp("NumOfReceivedPackets", mNumOfReceivedPackets);
+			if (!archiveCoreState(archive, "PacketSink", mPacketSink)
+					&& Archive::is_loading::value) {
+				restorePacketSink();
+			}
+
+			archive & boost::serialization::make_nvp("NumOfGeneratorQueries",
+					mNumOfGeneratorQueries);
+			uint64_t numOfGeneratorQueries = mNumOfGeneratorQueries;
+			if (!archiveCoreState(archive, "PacketGenerator", mPacketGenerator)
+					&& Archive::is_loading::value) {
+				mNumOfGeneratorQueries = 0;
+				replayPacketGenerator(numOfGeneratorQueries);
+			}
+		}
 	}
 };
 
+// Configuration files without a version only contain the fields
+BOOST_CLASS_VERSION(ProcessingElement, 1)
+
 #endif /* FRASER_TEMPLATE_RESOURCES_SRC_PROCESSINGELEMENT_H_ */
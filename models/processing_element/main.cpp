@@ -31,7 +31,8 @@ int main(int argc, char* argv[]) {
 		}
 
 		if (validArgs) {
-			ProcessingElement processingElement(peName,
+			zmq::context_t ctx(1);
+			ProcessingElement processingElement(ctx, peName,
 					"PE for Router: Packet Generator for Sending and Packet Sink for Receiving Flits");
 
 			try {
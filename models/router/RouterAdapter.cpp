@@ -13,14 +13,100 @@
 
 #include "RouterAdapter.h"
 
-RouterAdapter::RouterAdapter(std::string name, std::string description) :
-		mName(name), mDescription(description), mCtx(1), mSubscriber(mCtx), mPublisher(
-				mCtx), mDealer(mCtx, mName), mNocSize("NocSize", 2), mFifoSize(
+#include <algorithm>
+#include <array>
+
+// Names of the output ports and of the credit signals of the router
+// (names of the events) and the types of their events, by port
+static const std::array<std::string, RouterAdapter::NumOfPorts> portNames = {
+		"Local", "North", "East", "South", "West" };
+static const std::array<std::string, RouterAdapter::NumOfPorts> creditSignals = {
+		"Credit_in_L++", "Credit_in_N++", "Credit_in_E++", "Credit_in_S++",
+		"Credit_in_W++" };
+static const std::array<event::EventType, RouterAdapter::NumOfPorts> flitEventTypes = {
+		event::EventType_Local, event::EventType_North, event::EventType_East,
+		event::EventType_South, event::EventType_West };
+static const std::array<event::EventType, RouterAdapter::NumOfPorts> creditEventTypes = {
+		event::EventType_Credit_in_L, event::EventType_Credit_in_N,
+		event::EventType_Credit_in_E, event::EventType_Credit_in_S,
+		event::EventType_Credit_in_W };
+// Types of the flits, which are received at the input ports (e.g., the flits
+// of the North input come from the South output of the neighbour)
+static const std::array<event::EventType, RouterAdapter::NumOfPorts> inputEventTypes = {
+		event::EventType_PacketGenerator, event::EventType_South,
+		event::EventType_West, event::EventType_North, event::EventType_East };
+
+// Port of an event type (NumOfPorts, if the type belongs to no port)
+static RouterAdapter::Port findPort(
+		const std::array<event::EventType, RouterAdapter::NumOfPorts> &eventTypes,
+		event::EventType eventType) {
+	auto it = std::find(eventTypes.begin(), eventTypes.end(), eventType);
+	return static_cast<RouterAdapter::Port>(it - eventTypes.begin());
+}
+
+// Port of a direction, which is given by its first letter
+static RouterAdapter::Port getPort(char direction) {
+	switch (direction) {
+	case 'L':
+		return RouterAdapter::LocalPort;
+	case 'N':
+		return RouterAdapter::NorthPort;
+	case 'E':
+		return RouterAdapter::EastPort;
+	case 'S':
+		return RouterAdapter::SouthPort;
+	case 'W':
+		return RouterAdapter::WestPort;
+	default:
+		return RouterAdapter::NumOfPorts;
+	}
+}
+
+// Output port of the router (e.g., "North")
+static RouterAdapter::Port getOutputPort(const std::string &portName) {
+	return portName.empty() ? RouterAdapter::NumOfPorts : getPort(portName[0]);
+}
+
+// Port of a credit signal of the router (e.g., "Credit_in_N++")
+static RouterAdapter::Port getCreditPort(const std::string &creditSignal) {
+	const size_t directionIndex = std::string("Credit_in_").size();
+	return creditSignal.size() > directionIndex ?
+			getPort(creditSignal[directionIndex]) : RouterAdapter::NumOfPorts;
+}
+
+// Output port of the router, which is connected to the neighbour (2D mesh,
+// row-wise addresses). Returns NumOfPorts for routers which are not adjacent.
+static RouterAdapter::Port getNeighbourPort(uint16_t address,
+		uint16_t neighbourAddress, uint16_t nocSize) {
+	int x = address % nocSize;
+	int y = address / nocSize;
+	int neighbourX = neighbourAddress % nocSize;
+	int neighbourY = neighbourAddress / nocSize;
+
+	if (neighbourX == x && neighbourY == y - 1) {
+		return RouterAdapter::NorthPort;
+	} else if (neighbourX == x + 1 && neighbourY == y) {
+		return RouterAdapter::EastPort;
+	} else if (neighbourX == x && neighbourY == y + 1) {
+		return RouterAdapter::SouthPort;
+	} else if (neighbourX == x - 1 && neighbourY == y) {
+		return RouterAdapter::WestPort;
+	}
+
+	return RouterAdapter::NumOfPorts;
+}
+
+RouterAdapter::RouterAdapter(zmq::context_t &ctx, std::string name,
+		std::string description) :
+		mName(name), mDescription(description), mCtx(ctx), mSubscriber(mCtx), mPublisher(
+				mCtx), mDealer(mCtx, mName), mStepReporter(mCtx), mEventDispatcher(
+				this), mStateWriter(mCtx), mNocSize("NocSize", 2), mFifoSize(
 				"FifoSize", 4), mAddress("RouterAddress", "0000"), mConnectivityBits(
 				"ConnectivityBits", "0000"), mRoutingBits("RoutingBits",
 				"00000000") {
 
 	registerInterruptSignal();
+	this->registerEventHandlers();
 
 	mRun = this->prepare();
 	//this->init();
@@ -32,6 +118,18 @@ RouterAdapter::~RouterAdapter() {
 
 void RouterAdapter::init() {
 	// Set or calculate other parameters ...
+	// (the router is configured when its state is loaded)
+	this->setupLinks();
+}
+
+void RouterAdapter::configureRouter() {
+	// A loaded state replaces the state of the router
+	mRouter = Router();
+	for (auto &fifoFlits : mFifoFlits) {
+		fifoFlits.clear();
+	}
+	mCreditsInUse.fill(0);
+	mLastGrantedPort = NumOfPorts;
 
 	mRouter.setNocSize(mNocSize.getValue());
 	mRouter.setAddress(
@@ -41,29 +139,45 @@ void RouterAdapter::init() {
 	mRouter.setConnectivityBits(connectivityBits);
 	mRouter.setRoutingBits(std::bitset<16>(mRoutingBits.getValue()));
 	mRouter.setFifoSize(mFifoSize.getValue());
+}
 
-	if (connectivityBits[0]) {
-		mSubscriber.subscribeTo("South");
-		mSubscriber.subscribeTo("Credit_in_S++");
+void RouterAdapter::setupLinks() {
+	// The output ports are derived from the dependencies: Neighbours with an
+	// address are routers, the others are connected to the local port
+	mFlitTopics.fill(EventTopic());
+	mCreditTopics.fill(EventTopic());
+	auto address = static_cast<uint16_t>(std::bitset<16>(
+			mAddress.getValue()).to_ulong());
+
+	for (auto neighbour : mNeighbourAddresses) {
+		Port port = LocalPort;
+		if (!neighbour.second.empty()) {
+			auto neighbourAddress = static_cast<uint16_t>(std::bitset<16>(
+					neighbour.second).to_ulong());
+			port = getNeighbourPort(address, neighbourAddress,
+					mNocSize.getValue());
+		}
 
-	}
-	if (connectivityBits[1]) {
-		mSubscriber.subscribeTo("West");
-		mSubscriber.subscribeTo("Credit_in_W++");
+		if (port == NumOfPorts) {
+			std::cout << mName << ": " << neighbour.first
+					<< " is not adjacent and gets no link" << std::endl;
+			continue;
+		}
 
-	}
-	if (connectivityBits[2]) {
-		mSubscriber.subscribeTo("East");
-		mSubscriber.subscribeTo("Credit_in_E++");
-	}
-	if (connectivityBits[3]) {
-		mSubscriber.subscribeTo("North");
-		mSubscriber.subscribeTo("Credit_in_N++");
+		// Flits leave the router at the port, credits are returned to the
+		// neighbour from which the flit was received (e.g., Credit_in_N++)
+		mFlitTopics[port] = EventTopic(
+				getLinkTopic(neighbour.first, portNames[port]));
+		mCreditTopics[port] = EventTopic(
+				getLinkTopic(neighbour.first, creditSignals[port]));
 	}
 }
 
 bool RouterAdapter::prepare() {
 	mSubscriber.setOwnershipName(mName);
+	// Events of other hosts are verified before they are accessed
+	mSubscriber.setEventVerifier(
+			&verifyEventBuffer<event::VerifyEventBuffer>);
 
 	// Router initialization for the default configuration file
 	// Otherwise, all parameters would be initialized with zero
@@ -73,29 +187,72 @@ bool RouterAdapter::prepare() {
 	mRoutingBits.setValue(mDealer.getModelParameter(mName, "routingBits"));
 	mConnectivityBits.setValue(
 			mDealer.getModelParameter(mName, "connectivityBits"));
+	mClockMode = toClockMode(
+			mDealer.getModelParameter("simulation_model", "clockMode"));
+	mStateFormat = toStateFormat(
+			mDealer.getModelParameter("simulation_model", "stateFormat"));
+	mSavepointMode = toSavepointMode(
+			mDealer.getModelParameter("simulation_model", "savepointMode"));
+
+	if (!mPublisher.bindSocket(
+			mDealer.getModelParameter(mName, "bindEndpoints"))) {
+		return false;
+	}
+
+	// The clock is distributed by the clock relay of the host (if defined)
+	std::string clockSource = mDealer.getModelParameter(mName, "clockSource");
+	if (clockSource.empty()) {
+		clockSource = "simulation_model";
+	}
 
-	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName))) {
+	// Events of the clock source are received on the high-priority lane
+	if (!mSubscriber.connectToControlPub(
+			mDealer.getModelParameter(clockSource, "endpoint"))) {
 		return false;
 	}
 
-	if (!mSubscriber.connectToPub(mDealer.getIPFrom("simulation_model"),
-			mDealer.getPortNumFrom("simulation_model"))) {
+	if (!mStepReporter.connectToCollector(
+			mDealer.getModelParameter(clockSource, "stepEndpoint"))) {
+		return false;
+	}
+
+	// Asynchronous savepoints are reported as durable by the state writer
+	if (mSavepointMode == SavepointMode::Async
+			&& !mStateWriter.connectToCollector(
+					mDealer.getModelParameter(clockSource, "stepEndpoint"))) {
 		return false;
 	}
 
 	for (auto depModel : mDealer.getModelDependencies()) {
-		if (!mSubscriber.connectToPub(mDealer.getIPFrom(depModel),
-				mDealer.getPortNumFrom(depModel))) {
+		if (!mSubscriber.connectToPub(
+				mDealer.getModelParameter(depModel, "endpoint"))) {
 			return false;
 		}
+
+		mNeighbourAddresses[depModel] = mDealer.getModelParameter(depModel,
+				"address");
+
+		// Links with a latency are synchronized conservatively
+		std::string latency = mDealer.getModelParameter(mName,
+				depModel + "_latency");
+		if (mClockMode == ClockMode::Conservative && !latency.empty()) {
+			if (!mSynchronizer.addInputChannel(depModel, std::stoull(latency))) {
+				return false;
+			}
+		}
 	}
 
 	// Subscriptions to events
-	mSubscriber.subscribeTo("LoadState");
-	mSubscriber.subscribeTo("SaveState");
-	mSubscriber.subscribeTo("End");
-	mSubscriber.subscribeTo("PacketGenerator");
-	mSubscriber.subscribeTo("SimTimeChanged");
+	mSubscriber.subscribeToControl("LoadState");
+	mSubscriber.subscribeToControl("SaveState");
+	mSubscriber.subscribeToControl("ExportState");
+	mSubscriber.subscribeToControl("End");
+	mSubscriber.subscribeToControl("SimTimeChanged");
+	// Flits and credits of the neighbours (see LinkTopics.h)
+	mSubscriber.subscribeTo(getLinkPrefix(mName));
+	if (mClockMode == ClockMode::Conservative) {
+		mSubscriber.subscribeTo("Null");
+	}
 
 	// Synchronization
 	if (!mSubscriber.prepareSubSynchronization(
@@ -120,132 +277,413 @@ void RouterAdapter::run() {
 	}
 }
 
+void RouterAdapter::registerEventHandlers() {
+	mEventDispatcher.registerHandler(event::EventType_SimTimeChanged,
+			&RouterAdapter::handleSimTimeChanged);
+	mEventDispatcher.registerHandler(event::EventType_End,
+			&RouterAdapter::handleEnd);
+	mEventDispatcher.registerHandler(event::EventType_SaveState,
+			&RouterAdapter::handleSaveState);
+	mEventDispatcher.registerHandler(event::EventType_LoadState,
+			&RouterAdapter::handleLoadState);
+	mEventDispatcher.registerHandler(event::EventType_ExportState,
+			&RouterAdapter::handleExportState);
+
+	for (auto eventType : { event::EventType_PacketGenerator,
+			event::EventType_North, event::EventType_East,
+			event::EventType_South, event::EventType_West }) {
+		mEventDispatcher.registerHandler(eventType, &RouterAdapter::handleFlit);
+	}
+
+	for (auto eventType : { event::EventType_Credit_in_N,
+			event::EventType_Credit_in_E, event::EventType_Credit_in_S,
+			event::EventType_Credit_in_W }) {
+		mEventDispatcher.registerHandler(eventType,
+				&RouterAdapter::handleCredit);
+	}
+}
+
 void RouterAdapter::handleEvent() {
 	auto eventBuffer = mSubscriber.getEventBuffer();
 
 	auto receivedEvent = event::GetEvent(eventBuffer);
-	std::string eventName = receivedEvent->name()->str();
+
+	// Events of the neighbours, which were sent before the clock event or
+	// the savepoint request, can arrive after it (high-priority lane)
+	if (receivedEvent->type() == event::EventType_SimTimeChanged
+			|| receivedEvent->type() == event::EventType_SaveState
+			|| receivedEvent->type() == event::EventType_ExportState) {
+		this->receivePendingEvents();
+	}
+
+	// Conservative synchronization: Events of neighbours with a link latency are
+	// delivered in the step after the latency (the router can be ahead or behind)
+	if (mClockMode == ClockMode::Conservative
+			&& receivedEvent->source() != nullptr
+			&& mSynchronizer.isInputChannel(receivedEvent->source()->c_str())) {
+		this->handleNeighbourEvent(receivedEvent);
+		return;
+	}
+
 	mCurrentSimTime = receivedEvent->timestamp();
 	mRun = !foundCriticalSimCycle(mCurrentSimTime);
 
-	if (receivedEvent->event_data() != nullptr) {
-		auto dataRef = receivedEvent->event_data_flexbuffer_root();
+	mEventDispatcher.dispatch(receivedEvent);
+}
 
-		if (dataRef.IsUInt()) {
-			uint32_t flitData =
-					receivedEvent->event_data_flexbuffer_root().AsUInt32();
+void RouterAdapter::receivePendingEvents() {
+	// Dropped (invalid) events do not stop the draining. The received
+	// control event stays valid (buffer of its lane).
+	while (mSubscriber.hasPendingEvent()) {
+		if (mSubscriber.receivePendingEvent()) {
+			this->handleEvent();
+		}
+	}
+}
 
-			if (eventName == "PacketGenerator") {
-				mRouter.pushToLocalFIFO(flitData);
-			}
-			// Flit comes from the South output of the previous router
-			else if (eventName == "South") {
-				mRouter.pushToNorthFIFO(flitData);
-			}
-			// Flit comes from the West output of the previous router
-			else if (eventName == "West") {
-				mRouter.pushToEastFIFO(flitData);
+void RouterAdapter::handleSimTimeChanged(const event::Event* receivedEvent) {
+	// The simulation model can grant several steps at once (time window)
+	uint32_t numOfSteps = std::max<uint32_t>(receivedEvent->repeat(), 1);
+
+	if (mClockMode == ClockMode::Conservative) {
+		// The neighbours may only simulate the steps of the window after
+		// they know, that this model sends no earlier events
+		if (mSynchronizer.grantWindow(receivedEvent->timestamp(), numOfSteps,
+				receivedEvent->period())) {
+			this->sendNullMessage(receivedEvent->timestamp());
+			mPublisher.flushEvents();
+		}
+		mTimeStep = receivedEvent->period();
+		mFlitSentInWindow = false;
+		this->simulateSafeSteps();
+		return;
+	}
 
-			}
-			// Flit comes from the North output of the previous router
-			else if (eventName == "North") {
-				mRouter.pushToSouthFIFO(flitData);
+	bool flitSent = false;
 
-			}
-			// Flit comes from the East output of the previous router
-			else if (eventName == "East") {
-				mRouter.pushToWestFIFO(flitData);
+	for (uint32_t step = 0; step < numOfSteps; step++) {
+		mCurrentSimTime = receivedEvent->timestamp()
+				+ step * receivedEvent->period();
+		flitSent |= simulateStep();
+	}
 
-			}
-		} else if (dataRef.IsString()) {
-			std::string configPath =
-					receivedEvent->event_data_flexbuffer_root().AsString().str();
-
-			if (eventName == "SaveState") {
-				this->saveState(
-						std::string(configPath.begin(), configPath.end())
-								+ mName + ".config");
-			}
+	// Flits and credits of this cycle are sent together
+	mPublisher.flushEvents();
 
-			else if (eventName == "LoadState") {
-				this->loadState(
-						std::string(configPath.begin(), configPath.end())
-								+ mName + ".config");
-			}
-		}
+	// Acknowledge the finished step (simulation model waits for all models)
+	if (mClockMode != ClockMode::RealTime) {
+		mStepReporter.reportStepDone(
+				getNextActivityTime(receivedEvent->period(), flitSent));
 	}
+}
 
-	else if (eventName == "SimTimeChanged") {
-		// Send new Flit every clock cycle
+void RouterAdapter::handleEnd(const event::Event*) {
+	mRun = false;
+}
 
-		if (mRouter.arbitrateWithRoundRobinPrioritization()) {
-			sendFlit(mRouter.getNextFlit(), mRouter.getChosenOutputPort());
-			updateCreditCounter(mRouter.getCreditCntSignal());
+void RouterAdapter::handleSaveState(const event::Event* receivedEvent) {
+	std::string configPath;
+	if (!getStatePath(receivedEvent, configPath)) {
+		std::cout << mName << ": SaveState without a state path" << std::endl;
+		return;
+	}
+	if (mSavepointMode == SavepointMode::Async) {
+		this->snapshotState(configPath + mName + ".config",
+				receivedEvent->timestamp());
+	} else {
+		this->saveState(configPath + mName + ".config");
+	}
+}
+
+void RouterAdapter::handleLoadState(const event::Event* receivedEvent) {
+	std::string configPath;
+	if (!getStatePath(receivedEvent, configPath)) {
+		std::cout << mName << ": LoadState without a state path" << std::endl;
+		return;
+	}
+	this->loadState(configPath + mName + ".config");
+}
+
+void RouterAdapter::handleExportState(const event::Event* receivedEvent) {
+	std::string configPath;
+	if (!getStatePath(receivedEvent, configPath)) {
+		std::cout << mName << ": ExportState without a state path" << std::endl;
+		return;
+	}
+	this->storeState(configPath + mName + ".config", StateFormat::Xml);
+}
+
+void RouterAdapter::handleFlit(const event::Event* receivedEvent) {
+	// Burst of the processing element (flits in the order of their steps)
+	auto burst = getBurst(receivedEvent);
+	if (burst != nullptr) {
+		for (auto flit : *burst) {
+			this->receiveFlit(receivedEvent->type(), flit);
 		}
+		return;
+	}
+
+	uint32_t flit = 0;
+	if (getFlit(receivedEvent, flit)) {
+		this->receiveFlit(receivedEvent->type(), flit);
+	}
+}
+
+void RouterAdapter::handleCredit(const event::Event* receivedEvent) {
+	this->receiveCredit(receivedEvent->type(), getCreditCount(receivedEvent));
+}
+
+void RouterAdapter::receiveFlit(event::EventType eventType,
+		uint32_t flitData) {
+	Port port = findPort(inputEventTypes, eventType);
+	if (port == NumOfPorts) {
+		return;
+	}
+
+	pushToFifo(port, flitData);
+	mFifoFlits[port].push_back(flitData);
+}
+
+void RouterAdapter::pushToFifo(Port port, uint32_t flit) {
+	switch (port) {
+	case LocalPort:
+		mRouter.pushToLocalFIFO(flit);
+		break;
+	case NorthPort:
+		mRouter.pushToNorthFIFO(flit);
+		break;
+	case EastPort:
+		mRouter.pushToEastFIFO(flit);
+		break;
+	case SouthPort:
+		mRouter.pushToSouthFIFO(flit);
+		break;
+	case WestPort:
+		mRouter.pushToWestFIFO(flit);
+		break;
+	default:
+		break;
+	}
+}
+
+void RouterAdapter::receiveCredit(event::EventType eventType,
+		uint32_t count) {
+	// The local port has no credit counter (the processing element
+	// accepts every flit)
+	Port port = findPort(creditEventTypes, eventType);
+	if (port == NumOfPorts || port == LocalPort) {
+		return;
 	}
 
 	// Increase Credit Counter
-	else if (eventName == "Credit_in_N++") {
-		mRouter.increaseCreditCntNorth();
+	for (uint32_t i = 0; i < count; i++) {
+		switch (port) {
+		case NorthPort:
+			mRouter.increaseCreditCntNorth();
+			break;
+		case WestPort:
+			mRouter.increaseCreditCntWest();
+			break;
+		case EastPort:
+			mRouter.increaseCreditCntEast();
+			break;
+		case SouthPort:
+			mRouter.increaseCreditCntSouth();
+			break;
+		default:
+			break;
+		}
 	}
 
-	else if (eventName == "Credit_in_W++") {
-		mRouter.increaseCreditCntWest();
+	mCreditsInUse[port] -= std::min(count, mCreditsInUse[port]);
+}
+
+void RouterAdapter::handleNeighbourEvent(const event::Event* receivedEvent) {
+	const char *source = receivedEvent->source()->c_str();
+
+	auto burst = getBurst(receivedEvent);
+
+	if (receivedEvent->type() == event::EventType_Null) {
+		mSynchronizer.updateChannelTime(source, receivedEvent->timestamp());
+	} else if (burst != nullptr) {
+		// The flits of a burst are delivered in their order
+		for (auto flit : *burst) {
+			mSynchronizer.deferEvent(source, receivedEvent->timestamp(),
+					receivedEvent->type(), flit, true);
+		}
+	} else {
+		// The data of a deferred credit is the number of credits
+		uint32_t data = 0;
+		bool isFlit = getFlit(receivedEvent, data);
+		if (!isFlit) {
+			data = getCreditCount(receivedEvent);
+		}
+
+		mSynchronizer.deferEvent(source, receivedEvent->timestamp(),
+				receivedEvent->type(), data, isFlit);
 	}
 
-	else if (eventName == "Credit_in_E++") {
-		mRouter.increaseCreditCntEast();
+	this->simulateSafeSteps();
+}
+
+void RouterAdapter::simulateSafeSteps() {
+	bool stepSimulated = false;
+
+	while (mSynchronizer.canSimulateNextStep()) {
+		mCurrentSimTime = mSynchronizer.getNextStepTime();
+
+		// Deliver the events of the neighbours, which arrive in this step
+		DeferredEvent deferredEvent;
+		while (mSynchronizer.popDueEvent(mCurrentSimTime, deferredEvent)) {
+			auto eventType = static_cast<event::EventType>(deferredEvent.type);
+			if (deferredEvent.hasData) {
+				this->receiveFlit(eventType, deferredEvent.data);
+			} else {
+				this->receiveCredit(eventType, deferredEvent.data);
+			}
+		}
+
+		mFlitSentInWindow |= simulateStep();
+		mSynchronizer.finishStep();
+		stepSimulated = true;
 	}
 
-	else if (eventName == "Credit_in_S++") {
-		mRouter.increaseCreditCntSouth();
+	// Null message: No events will be sent before the next step. It is sent
+	// after the other events of the cycle and replaces the null messages
+	// of the single steps.
+	if (stepSimulated) {
+		this->sendNullMessage(mSynchronizer.getNextStepTime());
+		mPublisher.flushEvents();
 	}
 
-	else if (eventName == "End") {
-		mRun = false;
+	if (mSynchronizer.finishWindow()) {
+		mStepReporter.reportStepDone(
+				getNextActivityTime(mTimeStep, mFlitSentInWindow));
 	}
+}
+
+void RouterAdapter::sendNullMessage(uint64_t nextStepTime) {
+	auto &fbb = mEventEncoder.startEvent();
 
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("Null"), nextStepTime,
+					event::Priority_NORMAL_PRIORITY, 0, 0, event::EventData_NONE,
+					0, fbb.CreateString(mName), event::EventType_Null));
+
+	mPublisher.queueEvent(mNullTopic, mEventEncoder);
 }
 
-void RouterAdapter::sendFlit(uint32_t flit, std::string reqString) {
-	std::cout << mName << " sends " << flit << " to " << reqString << " output"
-			<< std::endl;
+bool RouterAdapter::simulateStep() {
+	// Send new Flit every clock cycle
+	if (mRouter.arbitrateWithRoundRobinPrioritization()) {
+		Port outputPort = getOutputPort(mRouter.getChosenOutputPort());
+		// The credit is returned to the input of the flit
+		Port inputPort = getCreditPort(mRouter.getCreditCntSignal());
+		sendFlit(mRouter.getNextFlit(), outputPort);
+		updateCreditCounter(inputPort);
+
+		if (inputPort != NumOfPorts) {
+			if (!mFifoFlits[inputPort].empty()) {
+				mFifoFlits[inputPort].pop_front();
+			}
+			mLastGrantedPort = inputPort;
+		}
+		if (outputPort != NumOfPorts && outputPort != LocalPort) {
+			mCreditsInUse[outputPort]++;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+bool RouterAdapter::hasBufferedFlits() const {
+	return std::any_of(mFifoFlits.begin(), mFifoFlits.end(),
+			[](const std::deque<uint32_t> &fifoFlits) {
+				return !fifoFlits.empty();
+			});
+}
+
+void RouterAdapter::restoreRouter() {
+	// The router core has no setters for its credit counters and arbiter.
+	// They are only restored exactly, if they still have their reset values.
+	uint32_t creditsInUse = 0;
+	for (auto credits : mCreditsInUse) {
+		creditsInUse += credits;
+	}
+	if (creditsInUse > 0 || mLastGrantedPort != NumOfPorts) {
+		throw MissingCoreState(
+				"the router core cannot restore its credit counters ("
+						+ std::to_string(creditsInUse)
+						+ " credits in use) and its arbiter");
+	}
+
+	// The flits are pushed into the FIFOs of the configured router again
+	for (uint32_t port = 0; port < NumOfPorts; port++) {
+		for (auto flit : mFifoFlits[port]) {
+			pushToFifo(static_cast<Port>(port), flit);
+		}
+	}
+}
+
+uint64_t RouterAdapter::getNextActivityTime(uint32_t timeStep, bool flitSent) {
+	// A sent flit has to be processed by the next router in the next step
+	if (flitSent || hasBufferedFlits()) {
+		return mCurrentSimTime + timeStep;
+	}
+
+	// Router wakes up again if it receives a flit
+	return NO_ACTIVITY;
+}
 
-	// Event Serialiazation
-	flatbuffers::FlatBufferBuilder fbb;
-	flatbuffers::Offset<event::Event> eventOffset;
+void RouterAdapter::sendFlit(uint32_t flit, Port port) {
+	if (port == NumOfPorts || mFlitTopics[port].empty()) {
+		std::cout << mName << ": No neighbour at the output of " << flit
+				<< std::endl;
+		return;
+	}
 
-	// Event Data Serialization
-	flexbuffers::Builder flexbuild;
-	flexbuild.Add(flit);
-	flexbuild.Finish();
-	auto data = fbb.CreateVector(flexbuild.GetBuffer());
+	std::cout << mName << " sends " << flit << " to " << portNames[port]
+			<< " output" << std::endl;
 
-	eventOffset = event::CreateEvent(fbb, fbb.CreateString(reqString),
-			mCurrentSimTime, event::Priority_NORMAL_PRIORITY, 0, 0, data);
+	// Event Serialiazation (reuses the memory of the previous event)
+	auto &fbb = mEventEncoder.startEvent();
+	auto data = fbb.CreateStruct(event::Flit(flit)).Union();
 
-	fbb.Finish(eventOffset);
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString(portNames[port]),
+					mCurrentSimTime, event::Priority_NORMAL_PRIORITY, 0, 0,
+					event::EventData_Flit, data, fbb.CreateString(mName),
+					flitEventTypes[port]));
 
-	mPublisher.publishEvent(reqString, fbb.GetBufferPointer(), fbb.GetSize());
+	mPublisher.queueEvent(mFlitTopics[port], mEventEncoder);
 }
 
-void RouterAdapter::updateCreditCounter(std::string eventName) {
-	flatbuffers::FlatBufferBuilder fbb;
-	flatbuffers::Offset<event::Event> eventOffset;
+void RouterAdapter::updateCreditCounter(Port port) {
+	if (port == NumOfPorts || mCreditTopics[port].empty()) {
+		return;
+	}
+
+	auto &fbb = mEventEncoder.startEvent();
+	auto data = fbb.CreateStruct(event::Credit(1)).Union();
 
-	eventOffset = event::CreateEvent(fbb, fbb.CreateString(eventName),
-			mCurrentSimTime);
-	fbb.Finish(eventOffset);
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString(creditSignals[port]),
+					mCurrentSimTime, event::Priority_NORMAL_PRIORITY, 0, 0,
+					event::EventData_Credit, data, fbb.CreateString(mName),
+					creditEventTypes[port]));
 
-	mPublisher.publishEvent(eventName, fbb.GetBufferPointer(), fbb.GetSize());
+	mPublisher.queueEvent(mCreditTopics[port], mEventEncoder);
 }
 
 void RouterAdapter::saveState(std::string filePath) {
+	this->storeState(filePath, mStateFormat);
+}
+
+void RouterAdapter::storeState(std::string filePath, StateFormat format) {
 // Store states
-	std::ofstream ofs(filePath);
-	boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
 	try {
-		oa << boost::serialization::make_nvp("FieldSet", *this);
+		saveStateArchive(filePath, format, "FieldSet", *this, &mDeltaBase);
 
 	} catch (boost::archive::archive_exception& ex) {
 		std::cout << mName << ": Archive Exception during serializing:"
@@ -256,21 +694,39 @@ void RouterAdapter::saveState(std::string filePath) {
 	mRun = mSubscriber.synchronizeSub();
 }
 
+void RouterAdapter::snapshotState(std::string filePath,
+		uint64_t savepointTime) {
+	// Only the snapshot is taken here, the simulation continues
+	// while the state writer stores it (no synchronization)
+	try {
+		mStateWriter.writeState(filePath, getStateImage("FieldSet", *this),
+				mStateFormat, savepointTime);
+
+	} catch (boost::archive::archive_exception& ex) {
+		std::cout << mName << ": Archive Exception during serializing:"
+				<< std::endl;
+		std::cout << ex.what() << std::endl;
+	}
+}
+
 void RouterAdapter::loadState(std::string filePath) {
-// Restore states
-	std::ifstream ifs(filePath);
-	boost::archive::xml_iarchive ia(ifs, boost::archive::no_header);
+	bool restored = true;
+// Restore states (binary or XML)
 	try {
-		ia >> boost::serialization::make_nvp("FieldSet", *this);
+		loadStateArchive(filePath, "FieldSet", *this);
 
 	} catch (boost::archive::archive_exception& ex) {
 		std::cout << mName << ": Archive Exception during deserializing:"
 				<< std::endl;
 		std::cout << ex.what() << std::endl;
+	} catch (MissingCoreState& ex) {
+		std::cout << mName << ": The state cannot be restored exactly, "
+				<< ex.what() << ". The model stops." << std::endl;
+		restored = false;
 	}
 
 	// Optional calculate parameters from the loaded initial state
 	init();
 
-	mRun = mSubscriber.synchronizeSub();
+	mRun = mSubscriber.synchronizeSub() && restored;
 }
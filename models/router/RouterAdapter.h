@@ -16,28 +16,48 @@
 
 #include <fstream>
 #include <queue>
+#include <deque>
 #include <string>
+#include <map>
+#include <array>
 #include <boost/serialization/serialization.hpp>
-#include <boost/archive/xml_oarchive.hpp>
-#include <boost/archive/xml_iarchive.hpp>
+#include <boost/serialization/version.hpp>
+#include <boost/serialization/deque.hpp>
 #include <zmq.hpp>
 #include <stdint.h>
 #include <bitset>
 
 #include "resources/idl/event_generated.h"
 #include "communication/zhelpers.hpp"
-#include "communication/Subscriber.h"
-#include "communication/Publisher.h"
+#include "common/communication/EventSubscriber.h"
+#include "common/communication/EventVerifier.h"
+#include "common/communication/EventPublisher.h"
+#include "common/communication/EventEncoder.h"
+#include "common/communication/EventTopic.h"
+#include "common/communication/EventPayload.h"
+#include "common/communication/LinkTopics.h"
 #include "communication/Dealer.h"
+#include "common/communication/StepReporter.h"
+#include "common/communication/EventDispatcher.h"
+#include "common/synchronization/ConservativeSynchronizer.h"
 #include "interfaces/IModel.h"
 #include "interfaces/IPersist.h"
 #include "data-types/Field.h"
+#include "common/data-types/ClockMode.h"
+#include "common/persistence/StateArchive.h"
+#include "common/persistence/StateWriter.h"
+#include "common/persistence/CoreState.h"
 #include "router/router.h"
 
 class RouterAdapter: public virtual IModel, public virtual IPersist {
 public:
+	// Ports of the router (index of the links to the neighbours)
+	enum Port {
+		LocalPort, NorthPort, EastPort, SouthPort, WestPort, NumOfPorts
+	};
 
-	RouterAdapter(std::string name, std::string description);
+	RouterAdapter(zmq::context_t &ctx, std::string name,
+			std::string description);
 	virtual ~RouterAdapter();
 
 	// IModel
@@ -64,18 +84,74 @@ private:
 
 	// Subscriber
 	void handleEvent();
+	// Receives the events of the neighbours, which are already pending
+	void receivePendingEvents();
+	void registerEventHandlers();
+	void handleSimTimeChanged(const event::Event* receivedEvent);
+	void handleEnd(const event::Event* receivedEvent);
+	void handleSaveState(const event::Event* receivedEvent);
+	void handleLoadState(const event::Event* receivedEvent);
+	void handleExportState(const event::Event* receivedEvent);
+	void handleFlit(const event::Event* receivedEvent);
+	void handleCredit(const event::Event* receivedEvent);
+	void receiveFlit(event::EventType eventType, uint32_t flitData);
+	void receiveCredit(event::EventType eventType, uint32_t count);
 
-	zmq::context_t mCtx;
-	Subscriber mSubscriber;
-	Publisher mPublisher;
+	zmq::context_t &mCtx;
+	EventSubscriber mSubscriber;
+	EventPublisher mPublisher;
+	EventEncoder mEventEncoder;
 	Dealer mDealer;
+	StepReporter mStepReporter;
+	EventDispatcher<RouterAdapter, event::Event, event::EventType_MAX + 1> mEventDispatcher;
 
 	bool mRun = false;
 	uint32_t mCurrentSimTime = 0;
+	ClockMode mClockMode = ClockMode::RealTime;
+	StateFormat mStateFormat = StateFormat::Xml;
+	// Last full savepoint (delta format)
+	DeltaBase mDeltaBase;
+	void storeState(std::string filePath, StateFormat format);
+	SavepointMode mSavepointMode = SavepointMode::Sync;
+	StateWriter mStateWriter;
+	void snapshotState(std::string filePath, uint64_t savepointTime);
+
+	bool simulateStep();
+	uint64_t getNextActivityTime(uint32_t timeStep, bool flitSent);
+
+	// Conservative synchronization with the neighbours (null messages)
+	ConservativeSynchronizer mSynchronizer;
+	uint32_t mTimeStep = 0;
+	bool mFlitSentInWindow = false;
+	EventTopic mNullTopic { "Null" };
+	void handleNeighbourEvent(const event::Event* receivedEvent);
+	void simulateSafeSteps();
+	void sendNullMessage(uint64_t nextStepTime);
 
 	Router mRouter;
-	void sendFlit(uint32_t, std::string reqString);
-	void updateCreditCounter(std::string signal);
+	void configureRouter();
+	void pushToFifo(Port port, uint32_t flit);
+	void sendFlit(uint32_t flit, Port port);
+	void updateCreditCounter(Port port);
+
+	// State of the router, which is observed at its interface (by input and
+	// output port): the flits in the input FIFOs, the credits in use (flits
+	// sent to the neighbour, for which no credit was returned yet) and the
+	// input which was granted last by the round-robin arbiter (NumOfPorts,
+	// if the arbiter did not grant a flit since the router was configured)
+	std::array<std::deque<uint32_t>, NumOfPorts> mFifoFlits;
+	std::array<uint32_t, NumOfPorts> mCreditsInUse { };
+	uint32_t mLastGrantedPort = NumOfPorts;
+	bool hasBufferedFlits() const;
+	void restoreRouter();
+
+	// Links to the neighbours: Address of each neighbour (empty for the local
+	// processing element) and the topics of the flits and credits of each port
+	// (empty, if no neighbour is connected to the port)
+	std::map<std::string, std::string> mNeighbourAddresses;
+	std::array<EventTopic, NumOfPorts> mFlitTopics;
+	std::array<EventTopic, NumOfPorts> mCreditTopics;
+	void setupLinks();
 
 	// Fields
 	Field<uint16_t> mNocSize;
@@ -86,13 +162,41 @@ private:
 
 	friend class boost::serialization::access;
 	template<typename Archive>
-	void serialize(Archive& archive, const unsigned int) {
+	void serialize(Archive& archive, const unsigned int version) {
 		archive & boost::serialization::make_nvp("IntField", mNocSize);
 		archive & boost::serialization::make_nvp("IntField", mFifoSize);
 		archive & boost::serialization::make_nvp("BitSetField", mAddress);
 		archive & boost::serialization::make_nvp("BitSetField", mConnectivityBits);
 		archive & boost::serialization::make_nvp("BitSetField", mRoutingBits);
+
+		// The router is configured before its dynamic state is restored
+		if (Archive::is_loading::value) {
+			configureRouter();
+		}
+
+		// Dynamic state (version 1), e.g., of a savepoint after the warm-up
+		if (version >= 1) {
+			archive & boost::serialization::make_nvp("CurrentSimTime", mCurrentSimTime);
+			archive & boost::serialization::make_nvp("Synchronizer", mSynchronizer);
+			for (auto &fifoFlits : mFifoFlits) {
+				archive & boost::serialization::make_nvp("FifoFlits", fifoFlits);
+			}
+			for (auto &creditsInUse : mCreditsInUse) {
+				archive & boost::serialization::make_nvp("CreditsInUse", creditsInUse);
+			}
+			archive & boost::serialization::make_nvp("LastGrantedPort", mLastGrantedPort);
+
+			// The observed state is only restored, if the router core is not
+			// serializable (see CoreState.h)
+			if (!archiveCoreState(archive, "Router", mRouter)
+					&& Archive::is_loading::value) {
+				restoreRouter();
+			}
+		}
 	}
 };
 
+// Configuration files without a version only contain the fields
+BOOST_CLASS_VERSION(RouterAdapter, 1)
+
 #endif /* FRASER_TEMPLATE_MODELS_ROUTER_1_ROUTER_H_ */
@@ -30,7 +30,8 @@ int main(int argc, char* argv[]) {
 		}
 
 		if (validArgs) {
-			RouterAdapter router(routerName, "Bonfire Router Model");
+			zmq::context_t ctx(1);
+			RouterAdapter router(ctx, routerName, "Bonfire Router Model");
 			try {
 				router.run();
 
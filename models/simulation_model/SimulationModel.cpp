@@ -14,10 +14,13 @@
 #include "SimulationModel.h"
 
 #include <iostream>
+#include <algorithm>
+#include <boost/filesystem.hpp>
 
-SimulationModel::SimulationModel(std::string name, std::string description) :
-		mName(name), mDescription(description), mCtx(1), mPublisher(mCtx), mDealer(
-				mCtx, mName), mSimTime("SimTime", 5000), mSimTimeStep(
+SimulationModel::SimulationModel(zmq::context_t &ctx, std::string name,
+		std::string description) :
+		mName(name), mDescription(description), mCtx(ctx), mPublisher(mCtx), mDealer(
+				mCtx, mName), mStepCollector(mCtx), mStateWriter(mCtx), mSimTime("SimTime", 5000), mSimTimeStep(
 				"SimTimeStep", 100), mCurrentSimTime("CurrentSimTime", 0), mCycleTime(
 				"CylceTime", 0), mSpeedFactor("SpeedFactor", 1.0) {
 
@@ -38,8 +41,63 @@ bool SimulationModel::prepare() {
 
 	mTotalNumOfModels = mDealer.getTotalNumberOfModels();
 	mNumOfPersistModels = mDealer.getNumberOfPersistModels();
+	mClockMode = toClockMode(mDealer.getModelParameter(mName, "clockMode"));
+	mStateFormat = toStateFormat(
+			mDealer.getModelParameter(mName, "stateFormat"));
+	mSavepointMode = toSavepointMode(
+			mDealer.getModelParameter(mName, "savepointMode"));
+	mCheckpointStore = toCheckpointStore(
+			mDealer.getModelParameter(mName, "checkpointStore"));
+	mCompressCheckpoints = mDealer.getModelParameter(mName,
+			"checkpointCompression") == "zlib";
+
+	// Clock relays aggregate the step reports of the models on their host
+	mNumOfClockSubscribers = mTotalNumOfModels - 2;
+	std::string numOfClockSubscribers = mDealer.getModelParameter(mName,
+			"numOfClockSubscribers");
+	if (!numOfClockSubscribers.empty()) {
+		mNumOfClockSubscribers = std::stoull(numOfClockSubscribers);
+	}
+
+	std::string windowSize = mDealer.getModelParameter(mName, "windowSize");
+	if (!windowSize.empty()) {
+		mWindowSize = std::max<uint32_t>(std::stoul(windowSize), 1);
+	}
+
+	// Periodic savepoints (in addition to the savepoints of the state)
+	std::string savepointInterval = mDealer.getModelParameter(mName,
+			"savepointInterval");
+	if (!savepointInterval.empty()) {
+		mSavepointSchedule.setInterval(std::stoull(savepointInterval));
+	}
+
+	std::string keepSavepoints = mDealer.getModelParameter(mName,
+			"keepSavepoints");
+	if (!keepSavepoints.empty()) {
+		mKeepSavepoints = std::stoul(keepSavepoints);
+	}
+
+	// Older savepoints can contain the base of a delta savepoint
+	if (mKeepSavepoints > 0 && mStateFormat == StateFormat::Delta) {
+		std::cout << mName << ": keepSavepoints is ignored in delta format"
+				<< std::endl;
+		mKeepSavepoints = 0;
+	}
+
+	if (!mPublisher.bindSocket(
+			mDealer.getModelParameter(mName, "bindEndpoints"))) {
+		return false;
+	}
 
-	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName))) {
+	if (!mStepCollector.bindSocket(
+			mDealer.getModelParameter(mName, "stepBindEndpoints"))) {
+		return false;
+	}
+
+	// The own savepoints are reported to the own step collector
+	if (mSavepointMode == SavepointMode::Async
+			&& !mStateWriter.connectToCollector(
+					mDealer.getModelParameter(mName, "stepEndpoint"))) {
 		return false;
 	}
 
@@ -63,33 +121,81 @@ bool SimulationModel::prepare() {
 
 void SimulationModel::run() {
 	uint64_t currentSimTime = getCurrentSimTime();
+
+	// The savepoints of the loaded state are sorted once
+	mSavepointSchedule.setSavepoints(mSavepoints);
+	mSavepointSchedule.start(currentSimTime);
+
 	if (mRun) {
 		while (currentSimTime <= mSimTime.getValue()) {
 			if (!mPause) {
 
-				for (auto savepoint : getSavepoints()) {
-					if (currentSimTime == savepoint) {
-						std::string filePath = "../savepoints/savepnt_"
-								+ std::to_string(savepoint) + "/" + mName
-								+ ".config";
+				bool periodic = false;
+				if (mSavepointSchedule.takeSavepoint(currentSimTime, periodic)) {
+					boost::system::error_code error;
+					boost::filesystem::create_directories(
+							getSavepointPath(currentSimTime), error);
 
-						this->saveState(filePath);
-						break;
+					if (periodic) {
+						mPeriodicSavepoints.push_back(currentSimTime);
 					}
+					this->saveState(getSavepointPath(currentSimTime));
 				}
 
 				//std::cout << "[SIMTIME] --> " << currentSimTime << std::endl;
-				mEventOffset = event::CreateEvent(mFbb,
-						mFbb.CreateString("SimTimeChanged"), currentSimTime);
-				mFbb.Finish(mEventOffset);
-				mPublisher.publishEvent("SimTimeChanged",
-						mFbb.GetBufferPointer(), mFbb.GetSize());
+				uint32_t numOfSteps = 1;
+				if (mClockMode != ClockMode::RealTime) {
+					numOfSteps = getNumOfStepsInWindow(currentSimTime);
+				}
+
+				// The period tells the models the size of a simulation step and
+				// repeat the number of steps they can simulate at once (time window)
+				auto &fbb = mEventEncoder.startEvent();
+				mEventEncoder.finishEvent(
+						event::CreateEvent(fbb,
+								fbb.CreateString("SimTimeChanged"),
+								currentSimTime, event::Priority_HIGH_PRIORITY,
+								numOfSteps, mSimTimeStep.getValue(),
+								event::EventData_NONE, 0, 0,
+								event::EventType_SimTimeChanged));
+				mPublisher.publishEvent(mSimTimeChangedTopic, mEventEncoder);
+
+				if (mClockMode == ClockMode::RealTime) {
+					std::this_thread::sleep_for(
+							std::chrono::milliseconds(mCycleTime.getValue()));
+
+					currentSimTime += mSimTimeStep.getValue();
+				} else {
+					// Do not sleep, but wait until all models (except the simulation
+					// and configuration model) finished the current time window.
+					// The reports are polled, so that an interrupt stops the waiting.
+					uint64_t nextActivityTime = NO_ACTIVITY;
+					while (!mStepCollector.collectStepReports(
+							mNumOfClockSubscribers, STEP_REPORT_TIMEOUT,
+							nextActivityTime)) {
+						if (interruptOccured) {
+							break;
+						}
+					}
+
+					if (interruptOccured) {
+						break;
+					}
 
-				std::this_thread::sleep_for(
-						std::chrono::milliseconds(mCycleTime.getValue()));
+					currentSimTime += (numOfSteps - 1) * mSimTimeStep.getValue();
+					if (mClockMode == ClockMode::NextEvent) {
+						currentSimTime = getNextSimTime(currentSimTime,
+								nextActivityTime);
+					} else {
+						currentSimTime += mSimTimeStep.getValue();
+					}
+				}
 
-				currentSimTime += mSimTimeStep.getValue();
 				mCurrentSimTime.setValue(currentSimTime);
+
+				if (!mPendingSavepoints.empty()) {
+					this->checkDurableSavepoints(false);
+				}
 			}
 
 			if (interruptOccured) {
@@ -98,16 +204,130 @@ void SimulationModel::run() {
 		}
 	}
 
+	// The models stop with the End event: Wait for the files of the
+	// asynchronous savepoints before
+	if (!interruptOccured) {
+		this->checkDurableSavepoints(true);
+	}
+
 	this->stopSim();
 }
 
+void SimulationModel::checkDurableSavepoints(bool wait) {
+	mStepCollector.receivePendingReports();
+
+	while (!mPendingSavepoints.empty()) {
+		// All persistent models (including the simulation model) report
+		uint64_t savepoint = mPendingSavepoints.front().first;
+		if (mStepCollector.getNumOfSavepointReports(savepoint)
+				< mNumOfPersistModels) {
+			if (!wait) {
+				break;
+			}
+
+			// No step report is outstanding (the window is finished)
+			uint64_t nextActivityTime = NO_ACTIVITY;
+			mStepCollector.receiveReport(nextActivityTime);
+			continue;
+		}
+
+		std::cout << "Savepoint " << savepoint << " is durable" << std::endl;
+		mStepCollector.removeSavepointReports(savepoint);
+		this->completeSavepoint(savepoint, mPendingSavepoints.front().second);
+		mPendingSavepoints.pop_front();
+	}
+}
+
+void SimulationModel::completeSavepoint(uint64_t time, std::string filePath) {
+	// All state files (of this host) are written
+	if (mCheckpointStore == CheckpointStore::Mapped) {
+		packCheckpoint(filePath);
+	} else if (mCheckpointStore == CheckpointStore::Archive) {
+		archiveCheckpoint(filePath, mCompressCheckpoints);
+	}
+
+	this->removeOldSavepoints(time);
+}
+
+std::string SimulationModel::getSavepointPath(uint64_t time) const {
+	return "../savepoints/savepnt_" + std::to_string(time) + "/";
+}
+
+void SimulationModel::removeOldSavepoints(uint64_t durableTime) {
+	if (mKeepSavepoints == 0) {
+		return;
+	}
+
+	size_t numOfDurable = std::upper_bound(mPeriodicSavepoints.begin(),
+			mPeriodicSavepoints.end(), durableTime)
+			- mPeriodicSavepoints.begin();
+
+	while (numOfDurable > mKeepSavepoints) {
+		// The directories of the models on the other hosts are not removed
+		// (and the chunks of an archived savepoint stay in the chunk store)
+		boost::system::error_code error;
+		boost::filesystem::remove_all(
+				getSavepointPath(mPeriodicSavepoints.front()), error);
+
+		mPeriodicSavepoints.pop_front();
+		numOfDurable--;
+	}
+}
+
+uint32_t SimulationModel::getNumOfStepsInWindow(uint64_t currentSimTime) {
+	uint64_t timeStep = mSimTimeStep.getValue();
+
+	// The window ends before the next savepoint and with the end of the simulation
+	uint64_t windowEnd = std::min(currentSimTime + mWindowSize * timeStep,
+			mSimTime.getValue() + timeStep);
+	uint64_t savepoint = mSavepointSchedule.getNextSavepoint();
+	if (savepoint > currentSimTime && savepoint < windowEnd) {
+		windowEnd = savepoint;
+	}
+
+	uint64_t numOfSteps = (windowEnd - currentSimTime + timeStep - 1)
+			/ timeStep;
+	return std::max<uint64_t>(numOfSteps, 1);
+}
+
+uint64_t SimulationModel::getNextSimTime(uint64_t currentSimTime,
+		uint64_t nextActivityTime) {
+	uint64_t timeStep = mSimTimeStep.getValue();
+	uint64_t nextSimTime = currentSimTime + timeStep;
+
+	if (nextActivityTime == NO_ACTIVITY) {
+		// Nothing to do anymore: Jump to the end of the simulation
+		nextSimTime = std::max(nextSimTime, mSimTime.getValue());
+	} else if (nextActivityTime > nextSimTime) {
+		// Round up to the next step, because the models are only
+		// triggered at multiples of the step size
+		uint64_t numOfSteps = (nextActivityTime - currentSimTime + timeStep - 1)
+				/ timeStep;
+		nextSimTime = currentSimTime + numOfSteps * timeStep;
+	}
+
+	// Savepoints must not be skipped. Like in the other modes, a savepoint
+	// between two steps is taken at the next step (the clock stays on the grid).
+	uint64_t savepoint = mSavepointSchedule.getNextSavepoint();
+	if (savepoint > currentSimTime && savepoint < nextSimTime) {
+		uint64_t numOfSteps = (savepoint - currentSimTime + timeStep - 1)
+				/ timeStep;
+		nextSimTime = currentSimTime + numOfSteps * timeStep;
+	}
+
+	return nextSimTime;
+}
+
 void SimulationModel::stopSim() {
 	// Stop all running models and the dns server
-	mEventOffset = event::CreateEvent(mFbb, mFbb.CreateString("End"),
-			mCurrentSimTime.getValue());
-	mFbb.Finish(mEventOffset);
+	auto &fbb = mEventEncoder.startEvent();
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("End"),
+					mCurrentSimTime.getValue(), event::Priority_HIGH_PRIORITY,
+					0, 0, event::EventData_NONE, 0, 0, event::EventType_End));
 
-	mPublisher.publishEvent("End", mFbb.GetBufferPointer(), mFbb.GetSize());
+	mPublisher.publishEvent("End", mEventEncoder.getBuffer(),
+			mEventEncoder.getSize());
 
 	mDealer.stopDNSserver();
 }
@@ -116,11 +336,9 @@ void SimulationModel::loadState(std::string filePath) {
 	std::cout << mName << " ... Load State" << std::endl;
 	this->pauseSim();
 
-	// Restore states
-	std::ifstream ifs(filePath + mName + ".config");
-	boost::archive::xml_iarchive ia(ifs, boost::archive::no_header);
+	// Restore states (binary or XML)
 	try {
-		ia >> boost::serialization::make_nvp("FieldSet", *this);
+		loadStateArchive(filePath + mName + ".config", "FieldSet", *this);
 
 	} catch (boost::archive::archive_exception& ex) {
 		std::cout << mName << ": Archive Exception during deserializing: "
@@ -128,19 +346,18 @@ void SimulationModel::loadState(std::string filePath) {
 		std::cout << ex.what() << std::endl;
 	}
 
-	// Event Data Serialization
-	flexbuffers::Builder flexbuild;
-	flexbuild.Add(filePath);
-	flexbuild.Finish();
-	auto data = mFbb.CreateVector(flexbuild.GetBuffer());
+	// Event Serialization
+	auto &fbb = mEventEncoder.startEvent();
+	auto data = fbb.CreateString(filePath).Union();
 
-	mEventOffset = event::CreateEvent(mFbb, mFbb.CreateString("LoadState"),
-			mCurrentSimTime.getValue(), event::Priority_NORMAL_PRIORITY, 0, 0,
-			data);
-	mFbb.Finish(mEventOffset);
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("LoadState"),
+					mCurrentSimTime.getValue(), event::Priority_HIGH_PRIORITY,
+					0, 0, event::EventData_String, data, 0,
+					event::EventType_LoadState));
 
-	mPublisher.publishEvent("LoadState", mFbb.GetBufferPointer(),
-			mFbb.GetSize());
+	mPublisher.publishEvent("LoadState", mEventEncoder.getBuffer(),
+			mEventEncoder.getSize());
 
 	this->init();
 
@@ -160,42 +377,87 @@ void SimulationModel::saveState(std::string filePath) {
 	std::cout << mName << " ... Save State" << std::endl;
 	this->pauseSim();
 
-	// Event Data Serialization
-	flexbuffers::Builder flexbuild;
-	flexbuild.Add(filePath);
-	flexbuild.Finish();
-	auto data = mFbb.CreateVector(flexbuild.GetBuffer());
-
-	mEventOffset = event::CreateEvent(mFbb, mFbb.CreateString("SaveState"),
-			mCurrentSimTime.getValue(), event::Priority_NORMAL_PRIORITY, 0, 0,
-			data);
-	mFbb.Finish(mEventOffset);
-	mPublisher.publishEvent("SaveState", mFbb.GetBufferPointer(),
-			mFbb.GetSize());
-
-	// Store states
-	std::ofstream ofs(filePath + mName + ".config");
-	boost::archive::xml_oarchive oa(ofs, boost::archive::no_header);
+	// Event Serialization
+	auto &fbb = mEventEncoder.startEvent();
+	auto data = fbb.CreateString(filePath).Union();
+
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("SaveState"),
+					mCurrentSimTime.getValue(), event::Priority_HIGH_PRIORITY,
+					0, 0, event::EventData_String, data, 0,
+					event::EventType_SaveState));
+	mPublisher.publishEvent("SaveState", mEventEncoder.getBuffer(),
+			mEventEncoder.getSize());
+
+	if (mSavepointMode == SavepointMode::Async) {
+		// The models take a snapshot and continue, the state writers
+		// report the savepoint when it is durable (checkDurableSavepoints)
+		try {
+			mStateWriter.writeState(filePath + mName + ".config",
+					getStateImage("FieldSet", *this), mStateFormat,
+					mCurrentSimTime.getValue());
+			mPendingSavepoints.push_back(
+					std::make_pair(mCurrentSimTime.getValue(), filePath));
+
+		} catch (boost::archive::archive_exception& ex) {
+			std::cout << mName << ": Archive Exception during serializing:"
+					<< std::endl;
+			std::cout << ex.what() << std::endl;
+		}
+	} else {
+		// Store states
+		this->storeState(filePath + mName + ".config", mStateFormat);
 
-	try {
-		oa << boost::serialization::make_nvp("FieldSet", *this);
+		// Synchronization is necessary, because the simulation
+		// has to wait until the other models finished their Store-method
+		// (mNumOfPersistModels - 1), because the simulation model itself should not be included
+		mRun = mPublisher.synchronizePub(mNumOfPersistModels - 1,
+				mCurrentSimTime.getValue());
 
-	} catch (boost::archive::archive_exception& ex) {
-		std::cout << mName << ": Archive Exception during serializing:"
-				<< std::endl;
-		std::cout << ex.what() << std::endl;
+		this->completeSavepoint(mCurrentSimTime.getValue(), filePath);
 	}
 
-	// Synchronization is necessary, because the simulation
-	// has to wait until the other models finished their Store-method
-	// (mNumOfPersistModels - 1), because the simulation model itself should not be included
-	mRun = mPublisher.synchronizePub(mNumOfPersistModels - 1,
-			mCurrentSimTime.getValue());
-
 	if (mConfigMode) {
+		this->checkDurableSavepoints(true);
 		std::cout << "Default configuration files were created" << std::endl;
 		this->stopSim();
 	} else {
 		this->continueSim();
 	}
 }
+
+void SimulationModel::exportState(std::string filePath) {
+	std::cout << mName << " ... Export State" << std::endl;
+	this->pauseSim();
+
+	// Event Serialization
+	auto &fbb = mEventEncoder.startEvent();
+	auto data = fbb.CreateString(filePath).Union();
+
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("ExportState"),
+					mCurrentSimTime.getValue(), event::Priority_HIGH_PRIORITY,
+					0, 0, event::EventData_String, data, 0,
+					event::EventType_ExportState));
+	mPublisher.publishEvent("ExportState", mEventEncoder.getBuffer(),
+			mEventEncoder.getSize());
+
+	this->storeState(filePath + mName + ".config", StateFormat::Xml);
+
+	// Wait until the other models stored their states
+	mRun = mPublisher.synchronizePub(mNumOfPersistModels - 1,
+			mCurrentSimTime.getValue());
+
+	this->stopSim();
+}
+
+void SimulationModel::storeState(std::string filePath, StateFormat format) {
+	try {
+		saveStateArchive(filePath, format, "FieldSet", *this, &mDeltaBase);
+
+	} catch (boost::archive::archive_exception& ex) {
+		std::cout << mName << ": Archive Exception during serializing:"
+				<< std::endl;
+		std::cout << ex.what() << std::endl;
+	}
+}
@@ -18,17 +18,24 @@
 #include <string>
 #include <fstream>
 #include <chrono>
+#include <deque>
+#include <utility>
 #include <zmq.hpp>
 #include <boost/thread.hpp>
 #include <boost/serialization/serialization.hpp>
-#include <boost/archive/xml_oarchive.hpp>
-#include <boost/archive/xml_iarchive.hpp>
 
 #include "data-types/SavepointSet.h"
+#include "common/data-types/ClockMode.h"
+#include "common/scheduler/SavepointSchedule.h"
+#include "common/persistence/StateArchive.h"
+#include "common/persistence/StateWriter.h"
 #include "interfaces/IModel.h"
 #include "interfaces/IPersist.h"
-#include "communication/Publisher.h"
+#include "common/communication/EventPublisher.h"
+#include "common/communication/EventEncoder.h"
+#include "common/communication/EventTopic.h"
 #include "communication/Dealer.h"
+#include "common/communication/StepCollector.h"
 #include "data-types/Field.h"
 #include "communication/zhelpers.hpp"
 
@@ -37,7 +44,8 @@
 
 class SimulationModel: public virtual IModel, public virtual IPersist {
 public:
-	SimulationModel(std::string name, std::string description);
+	SimulationModel(zmq::context_t &ctx, std::string name,
+			std::string description);
 
 	virtual ~SimulationModel();
 
@@ -66,6 +74,10 @@ public:
 
 	void stopSim();
 
+	/** Stores the state of all models in configPath as XML, e.g., to read a
+	 * binary savepoint which was loaded before (see stateFormat) **/
+	void exportState(std::string configPath);
+
 	void setConfigMode(bool status) {
 		mConfigMode = status;
 	}
@@ -80,11 +92,12 @@ public:
 	 * the store method of all subscribed models and of the simulation-model itself is called. **/
 	void setSavepoint(uint64_t time) {
 		mSavepoints.push_back(time);
+		mSavepointSchedule.addSavepoint(time);
 	}
 
-	/** Get all breakpoint which were defined. **/
-	std::vector<uint64_t> getSavepoints() {
-		return mSavepoints;
+	/** Get all breakpoint which were defined (sorted). **/
+	const std::vector<uint64_t>& getSavepoints() const {
+		return mSavepointSchedule.getSavepoints();
 	}
 
 private:
@@ -93,22 +106,71 @@ private:
 	std::string mDescription;
 
 	// For the communication
-	zmq::context_t mCtx;  // ZMQ-instance
-	Publisher mPublisher; // ZMQ-PUB
+	zmq::context_t &mCtx; // ZMQ-instance
+	EventPublisher mPublisher; // ZMQ-PUB
 	Dealer mDealer;		  // ZMQ-DEALER
+	StepCollector mStepCollector; // ZMQ-PULL
+
+	/** Returns the number of steps which are granted to the models with the next
+	 * SimTimeChanged event. A time window never includes a savepoint (except the first step).
+	 * The window is not ended early, if a model sends a flit: In the afap and
+	 * next-event modes, the receiver processes the events of a window in its
+	 * next window (a latency of up to windowSize steps). Only the conservative
+	 * mode delivers them in the step of their timestamp. **/
+	uint32_t getNumOfStepsInWindow(uint64_t currentSimTime);
+
+	/** Returns the next simulation time in next-event mode: The earliest
+	 * activity of all models rounded up to the step size. **/
+	uint64_t getNextSimTime(uint64_t currentSimTime, uint64_t nextActivityTime);
 
 	SavepointSet mSavepoints;
+	// Explicit savepoints (mSavepoints) and the periodic rule
+	SavepointSchedule mSavepointSchedule;
+	// Only the last periodic savepoints are kept (0: all)
+	uint32_t mKeepSavepoints = 0;
+	std::deque<uint64_t> mPeriodicSavepoints;
+	std::string getSavepointPath(uint64_t time) const;
+	/** Removes the oldest periodic savepoints, which exceed the number of
+	 * savepoints to keep (only savepoints up to the durable time count) **/
+	void removeOldSavepoints(uint64_t durableTime);
 	bool mRun = true;
 	bool mPause = false;
 	bool mConfigMode = false;
 	bool mLoadConfigFile = false;
+	ClockMode mClockMode = ClockMode::RealTime;
+	StateFormat mStateFormat = StateFormat::Xml;
+	// Last full savepoint (delta format)
+	DeltaBase mDeltaBase;
+	void storeState(std::string filePath, StateFormat format);
+
+	// Asynchronous savepoints: The simulation continues after the snapshots,
+	// the savepoints are durable when all persistent models reported them
+	SavepointMode mSavepointMode = SavepointMode::Sync;
+	StateWriter mStateWriter;
+	// Time and path of the savepoints, which are not durable yet
+	std::deque<std::pair<uint64_t, std::string>> mPendingSavepoints;
+	/** Reports the pending savepoints, which are durable. Waits until all
+	 * pending savepoints are durable, if wait is set. **/
+	void checkDurableSavepoints(bool wait);
+
+	CheckpointStore mCheckpointStore = CheckpointStore::Files;
+	// Chunks of the archive are compressed with zlib
+	bool mCompressCheckpoints = false;
+	/** Called when all models stored the savepoint (packs or archives the
+	 * state files, see CheckpointStore) **/
+	void completeSavepoint(uint64_t time, std::string filePath);
+
+	// Number of steps which are granted at once (not in real-time mode)
+	uint32_t mWindowSize = 1;
 
 	uint64_t mTotalNumOfModels = 0;
 	uint64_t mNumOfPersistModels = 0;
+	// Models and clock relays which report directly to the simulation model
+	uint64_t mNumOfClockSubscribers = 0;
 
 	// Event Serialiazation
-	flatbuffers::FlatBufferBuilder mFbb;
-	flatbuffers::Offset<event::Event> mEventOffset;
+	EventEncoder mEventEncoder;
+	EventTopic mSimTimeChangedTopic { "SimTimeChanged" };
 
 	friend class boost::serialization::access;
 	template<typename Archive>
@@ -19,7 +19,9 @@
 int main(int argc, char* argv[]) {
 	if (argc > 2) {
 		std::string configFilePath = argv[2];
-		SimulationModel simulation("simulation_model", "Simulation Environment");
+		zmq::context_t ctx(1);
+		SimulationModel simulation(ctx, "simulation_model",
+				"Simulation Environment");
 
 		if (static_cast<std::string>(argv[1]) == "--create-config-files") {
 			std::cout << "Create default configuration files" << std::endl;
@@ -30,6 +32,11 @@ int main(int argc, char* argv[]) {
 			simulation.loadState(configFilePath);
 			simulation.run();
 
+		} else if (static_cast<std::string>(argv[1]) == "--export-xml"
+				&& argc > 3) {
+			simulation.loadState(configFilePath);
+			simulation.exportState(argv[3]);
+
 		} else {
 			std::cout << " Invalid argument/s: --help" << std::endl;
 		}
@@ -42,6 +49,9 @@ int main(int argc, char* argv[]) {
 			std::cout
 					<< "--load-config CONFIG-PATH >> Define path of configuration file/s"
 					<< std::endl;
+			std::cout << "--export-xml CONFIG-PATH EXPORT-PATH >> Load the "
+					<< "configuration files (e.g., a binary savepoint) and "
+					<< "save them as XML in EXPORT-PATH" << std::endl;
 		} else {
 			std::cout << " Invalid argument/s: --help" << std::endl;
 		}
@@ -13,11 +13,13 @@
 
 #include "SystemcAdapter.h"
 
+#include <algorithm>
+
 SystemcAdapter::SystemcAdapter(std::string name, std::string description,
 		sc_core::sc_module_name instance_name) :
 		sc_core::sc_module(instance_name), mName(name), mDescription(
 				description), mCtx(1), mSubscriber(mCtx), mPublisher(mCtx), mDealer(
-				mCtx, mName) {
+				mCtx, mName), mStepReporter(mCtx) {
 
 	// *********************************************
 	// Register callbacks for incoming interface method calls
@@ -40,30 +42,50 @@ void SystemcAdapter::init() {
 bool SystemcAdapter::prepare() {
 
 	mSubscriber.setOwnershipName(mName);
+	// Events of other hosts are verified before they are accessed
+	mSubscriber.setEventVerifier(
+			&verifyEventBuffer<event::VerifyEventBuffer>);
+	mClockMode = toClockMode(
+			mDealer.getModelParameter("simulation_model", "clockMode"));
+
+	if (!mPublisher.bindSocket(
+			mDealer.getModelParameter(mName, "bindEndpoints"))) {
+		std::cout << mName << " could not bind to its endpoints" << std::endl;
+		return false;
+	}
 
-	if (!mPublisher.bindSocket(mDealer.getPortNumFrom(mName))) {
-		std::cout << mName << " could not bind to port "
-				<< mDealer.getPortNumFrom(mName) << std::endl;
+	// The clock is distributed by the clock relay of the host (if defined)
+	std::string clockSource = mDealer.getModelParameter(mName, "clockSource");
+	if (clockSource.empty()) {
+		clockSource = "simulation_model";
+	}
+
+	// Events of the clock source are received on the high-priority lane
+	if (!mSubscriber.connectToControlPub(
+			mDealer.getModelParameter(clockSource, "endpoint"))) {
 		return false;
 	}
 
-	if (!mSubscriber.connectToPub(mDealer.getIPFrom("simulation_model"),
-			mDealer.getPortNumFrom("simulation_model"))) {
+	if (!mStepReporter.connectToCollector(
+			mDealer.getModelParameter(clockSource, "stepEndpoint"))) {
 		return false;
 	}
 
 	for (auto depModel : mDealer.getModelDependencies()) {
-		if (!mSubscriber.connectToPub(mDealer.getIPFrom(depModel),
-				mDealer.getPortNumFrom(depModel))) {
+		if (!mSubscriber.connectToPub(
+				mDealer.getModelParameter(depModel, "endpoint"))) {
 			return false;
 		}
+
+		// The adapter is connected to the local port of the router
+		mRouterLinkTopic = EventTopic(
+				getLinkTopic(depModel, "PacketGenerator"));
 	}
 
-	// Subscriptions to events
-	mSubscriber.subscribeTo("SimTimeChanged");
-	mSubscriber.subscribeTo("Credit_in_L++");
-	mSubscriber.subscribeTo("Local");
-	mSubscriber.subscribeTo("End");
+	// Subscriptions to events (flits and credits, see LinkTopics.h)
+	mSubscriber.subscribeToControl("SimTimeChanged");
+	mSubscriber.subscribeTo(getLinkPrefix(mName));
+	mSubscriber.subscribeToControl("End");
 
 	// Synchronization
 	if (!mSubscriber.prepareSubSynchronization(
@@ -92,23 +114,18 @@ void SystemcAdapter::b_transport(tlm::tlm_generic_payload& trans,
 	cout << "SystemcAdapter publishes Flit: " << mCurrentSimTime << " <-- "
 			<< in_flit << endl;
 
-	// Event Serialiazation
-	flatbuffers::FlatBufferBuilder fbb;
-	flatbuffers::Offset<event::Event> eventOffset;
-
-	// Event Data Serialization
-	flexbuffers::Builder flexbuild;
-	flexbuild.Add(in_flit);
-	flexbuild.Finish();
-	auto data = fbb.CreateVector(flexbuild.GetBuffer());
+	// Event Serialiazation (reuses the memory of the previous event)
+	auto &fbb = mEventEncoder.startEvent();
+	auto data = fbb.CreateStruct(event::Flit(in_flit)).Union();
 
-	std::string reqString = "PacketGenerator";
-	eventOffset = event::CreateEvent(fbb, fbb.CreateString(reqString),
-			mCurrentSimTime, event::Priority_NORMAL_PRIORITY, 0, 0, data);
+	mEventEncoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("PacketGenerator"),
+					mCurrentSimTime, event::Priority_NORMAL_PRIORITY, 0, 0,
+					event::EventData_Flit, data, 0,
+					event::EventType_PacketGenerator));
 
-	fbb.Finish(eventOffset);
-
-	mPublisher.publishEvent(reqString, fbb.GetBufferPointer(), fbb.GetSize());
+	mPublisher.publishEvent(mRouterLinkTopic, mEventEncoder);
+	mSystemcActive = true;
 
 	trans.set_response_status(tlm::TLM_OK_RESPONSE);
 }
@@ -127,36 +144,50 @@ void SystemcAdapter::handleEvent() {
 	auto eventBuffer = mSubscriber.getEventBuffer();
 	auto receivedEvent = event::GetEvent(eventBuffer);
 
-	std::string eventName = receivedEvent->name()->str();
+	auto eventType = receivedEvent->type();
 	mCurrentSimTime = receivedEvent->timestamp();
 	mRun = !foundCriticalSimCycle(mCurrentSimTime);
 	sc_time delay = sc_time(100, SC_MS);
 
-	if (receivedEvent->event_data() != nullptr) {
-		auto dataRef = receivedEvent->event_data_flexbuffer_root();
+	// Events without data (or with a union type but no value) are not forwarded
+	uint32_t flitData = 0;
+	bool isFlit = getFlit(receivedEvent, flitData);
+	auto flexData = receivedEvent->data_as_FlexData();
+	if (isFlit || (flexData != nullptr && flexData->value() != nullptr)) {
 
 		// TLM-2 generic payload transaction, reused across calls to b_transport
 		tlm::tlm_generic_payload* trans = new tlm::tlm_generic_payload;
 
-		if (dataRef.IsUInt()) {
-			auto uintData = dataRef.AsUInt64();
-			trans->set_data_ptr(reinterpret_cast<unsigned char*>(&uintData));
+		// Flits have a fixed layout, only generic data has to be probed
+		if (isFlit) {
+			trans->set_data_ptr(reinterpret_cast<unsigned char*>(&flitData));
+
+		} else {
+			auto dataRef = flexData->value_flexbuffer_root();
 
-		} else if (dataRef.IsInt()) {
-			auto intData = dataRef.AsInt64();
-			trans->set_data_ptr(reinterpret_cast<unsigned char*>(&intData));
+			if (dataRef.IsUInt()) {
+				auto uintData = dataRef.AsUInt64();
+				trans->set_data_ptr(reinterpret_cast<unsigned char*>(&uintData));
 
-		} else if (dataRef.IsFloat()) {
-			auto floatData = dataRef.AsFloat();
-			trans->set_data_ptr(reinterpret_cast<unsigned char*>(&floatData));
+			} else if (dataRef.IsInt()) {
+				auto intData = dataRef.AsInt64();
+				trans->set_data_ptr(reinterpret_cast<unsigned char*>(&intData));
 
-		} else if (dataRef.IsString()) {
-			auto stringData = dataRef.AsString();
-			trans->set_data_ptr(reinterpret_cast<unsigned char*>(&stringData));
+			} else if (dataRef.IsFloat()) {
+				auto floatData = dataRef.AsFloat();
+				trans->set_data_ptr(
+						reinterpret_cast<unsigned char*>(&floatData));
 
-		} else if (dataRef.IsVector()) {
-			auto vectorData = dataRef.AsVector();
-			trans->set_data_ptr(reinterpret_cast<unsigned char*>(&vectorData));
+			} else if (dataRef.IsString()) {
+				auto stringData = dataRef.AsString();
+				trans->set_data_ptr(
+						reinterpret_cast<unsigned char*>(&stringData));
+
+			} else if (dataRef.IsVector()) {
+				auto vectorData = dataRef.AsVector();
+				trans->set_data_ptr(
+						reinterpret_cast<unsigned char*>(&vectorData));
+			}
 		}
 
 		cout << "Flit from pkt-gen: " << "" << endl;
@@ -169,8 +200,9 @@ void SystemcAdapter::handleEvent() {
 		trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
 		mInitMemorySocket->b_transport(*trans, delay); //blocking call
+		mSystemcActive = true;
 
-	} else if (eventName == "Credit_in_L++") {
+	} else if (eventType == event::EventType_Credit_in_L) {
 		// TLM-2 generic payload transaction, reused across calls to b_transport
 		tlm::tlm_generic_payload* creditCntTrans = new tlm::tlm_generic_payload;
 		// set the transaction
@@ -183,9 +215,10 @@ void SystemcAdapter::handleEvent() {
 		creditCntTrans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
 
 		mInitCreditCntSocket->b_transport(*creditCntTrans, delay);
+		mSystemcActive = true;
 	}
 
-	else if (eventName == "End") {
+	else if (eventType == event::EventType_End) {
 		mRun = false;
 
 		tlm::tlm_generic_payload* interruptTrans = new tlm::tlm_generic_payload;
@@ -202,5 +235,24 @@ void SystemcAdapter::handleEvent() {
 	}
 
 	wait(delay);
+
+	// Acknowledge the finished step (simulation model waits for all models).
+	// The SystemC models are not visible to FRASER: The adapter requests the
+	// step after the granted time window, if the SystemC side exchanged
+	// flits or credits in this window or if SystemC processes are still
+	// pending (e.g., a generator, which is driven by its own timed events).
+	// Otherwise, it wakes up again with the next flit or credit of the router.
+	if (eventType == event::EventType_SimTimeChanged
+			&& mClockMode != ClockMode::RealTime) {
+		uint32_t numOfSteps = std::max<uint32_t>(receivedEvent->repeat(), 1);
+		uint64_t nextActivityTime = NO_ACTIVITY;
+		if (mSystemcActive || sc_core::sc_pending_activity()) {
+			nextActivityTime = mCurrentSimTime
+					+ numOfSteps * receivedEvent->period();
+		}
+
+		mStepReporter.reportStepDone(nextActivityTime);
+		mSystemcActive = false;
+	}
 }
 
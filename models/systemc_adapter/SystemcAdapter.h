@@ -30,10 +30,17 @@ using namespace std;
 #include <zmq.hpp>
 
 #include "interfaces/IModel.h"
+#include "common/data-types/ClockMode.h"
 #include "communication/zhelpers.hpp"
-#include "communication/Subscriber.h"
-#include "communication/Publisher.h"
+#include "common/communication/EventSubscriber.h"
+#include "common/communication/EventVerifier.h"
+#include "common/communication/EventPublisher.h"
+#include "common/communication/EventEncoder.h"
+#include "common/communication/EventTopic.h"
+#include "common/communication/EventPayload.h"
+#include "common/communication/LinkTopics.h"
 #include "communication/Dealer.h"
+#include "common/communication/StepReporter.h"
 #include "resources/idl/event_generated.h"
 
 /** Receives Data from SystemC-models and forward it to FRASER specific models (publish data). **/
@@ -75,15 +82,23 @@ private:
 
 	// For the communication
 	zmq::context_t mCtx;  // ZMQ-instance
-	Subscriber mSubscriber; // ZMQ-SUB
-	Publisher mPublisher; // ZMQ-PUB
+	EventSubscriber mSubscriber; // ZMQ-SUB
+	EventPublisher mPublisher; // ZMQ-PUB
+	EventEncoder mEventEncoder;
+	// Topic of the flits to the router (see LinkTopics.h)
+	EventTopic mRouterLinkTopic;
 	Dealer mDealer;		  // ZMQ-DEALER
+	StepReporter mStepReporter; // ZMQ-PUSH
 
 	// Subscriber
 	void handleEvent();
 
 	bool mRun = false;
 	uint32_t mCurrentSimTime = 0;
+	ClockMode mClockMode = ClockMode::RealTime;
+	// The SystemC side sent or received flits or credits in the current
+	// time window (it has pending work in the next step)
+	bool mSystemcActive = false;
 
 };
 
@@ -8,5 +8,10 @@ models/router/build/bin/router -n router_3 &
 models/processing_element/build/bin/processing_element -n processing_element_1 &
 models/processing_element/build/bin/processing_element -n processing_element_2 &
 models/processing_element/build/bin/processing_element -n processing_element_3 &
+models/event_queue_1/build/bin/event_queue_1 &
 models/systemc_adapter/build/bin/systemc_adapter &
 models/simulation_model/build/bin/simulation_model --load-config configurations/config_0/
+
+# Alternatively, run the models (except the SystemC adapter) as threads of one process:
+# tools/model_runner/build/bin/model_runner --config-file hosts-configs/config0.xml --load-config configurations/config_0/ &
+# models/systemc_adapter/build/bin/systemc_adapter
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "common/communication/EventEncoder.h"
+#include "common/communication/EventPayload.h"
+#include "resources/idl/event_generated.h"
+
+// Size and decode time of a flit event of the router: with the typed payload
+// (Flit struct) and with the generic payload (flexbuffer in FlexData), which
+// has the encoding of the former event_data field.
+//
+// Usage: bench_payload [number of flits (default: 1000000)]
+
+static std::vector<uint8_t> encodeFlit(EventEncoder &encoder, uint32_t flit,
+		bool typed) {
+	auto &fbb = encoder.startEvent();
+	flatbuffers::Offset<void> data;
+	if (typed) {
+		data = fbb.CreateStruct(event::Flit(flit)).Union();
+	} else {
+		data = event::CreateFlexData(fbb, encoder.createFlexbuffer(flit)).Union();
+	}
+
+	encoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString("East"), 1000,
+					event::Priority_NORMAL_PRIORITY, 0, 0,
+					typed ? event::EventData_Flit : event::EventData_FlexData,
+					data, fbb.CreateString("router_0"), event::EventType_East));
+
+	return std::vector<uint8_t>(encoder.getBuffer(),
+			encoder.getBuffer() + encoder.getSize());
+}
+
+// Reads the flit like the models do (typed: single load, generic: type probing)
+static uint32_t decodeFlit(const uint8_t *buffer) {
+	auto receivedEvent = event::GetEvent(buffer);
+	uint32_t flit = 0;
+	if (getFlit(receivedEvent, flit)) {
+		return flit;
+	}
+
+	auto flexData = receivedEvent->data_as_FlexData();
+	if (flexData != nullptr && flexData->value() != nullptr) {
+		auto dataRef = flexData->value_flexbuffer_root();
+		if (dataRef.IsUInt()) {
+			flit = dataRef.AsUInt32();
+		}
+	}
+	return flit;
+}
+
+static void runBenchmark(uint64_t numOfFlits, bool typed) {
+	EventEncoder encoder;
+
+	// Different flits (small and 32-bit values), so that the flexbuffers have
+	// their usual widths
+	std::vector<std::vector<uint8_t>> events;
+	size_t totalSize = 0;
+	for (uint32_t i = 0; i < 1024; i++) {
+		uint32_t flit = (i % 2 == 0) ? i % 64 : 0x80000000 | (i << 8);
+		events.push_back(encodeFlit(encoder, flit, typed));
+		totalSize += events.back().size();
+	}
+
+	uint64_t checksum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < numOfFlits; i++) {
+		checksum += decodeFlit(events[i % events.size()].data());
+	}
+	std::chrono::nanoseconds duration = std::chrono::steady_clock::now()
+			- start;
+
+	std::cout << (typed ? "Flit    " : "FlexData") << ": "
+			<< double(totalSize) / events.size() << " bytes/event, "
+			<< double(duration.count()) / numOfFlits << " ns/decode (checksum "
+			<< checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	uint64_t numOfFlits = 1000000;
+	if (argc > 1) {
+		numOfFlits = std::strtoull(argv[1], nullptr, 10);
+	}
+
+	std::cout << "Decode " << numOfFlits << " flit events" << std::endl;
+	runBenchmark(numOfFlits, true);
+	runBenchmark(numOfFlits, false);
+
+	return 0;
+}
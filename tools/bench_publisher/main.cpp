@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <zmq.hpp>
+
+#include "common/communication/EventPublisher.h"
+#include "common/communication/EventEncoder.h"
+#include "common/communication/EventTopic.h"
+#include "common/communication/LinkTopics.h"
+#include "resources/idl/event_generated.h"
+
+// Sends the flits and credits of a router (one flit and one credit per cycle)
+// through the EventPublisher and counts the allocations (malloc, also of ZMQ
+// and its I/O thread) per flit: once with copied messages (name and buffer)
+// and once without a copy (EventTopic and the builders of the EventEncoder).
+//
+// Usage: bench_publisher [number of flits (default: 100000)]
+
+static std::atomic<uint64_t> numOfAllocations(0);
+
+extern "C" void *__libc_malloc(size_t size);
+
+extern "C" void *malloc(size_t size) {
+	numOfAllocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+#define BENCH_ENDPOINT "inproc://bench_publisher"
+
+static void encodeEvent(EventEncoder &encoder, const std::string &name,
+		uint64_t time, event::EventData dataType, uint32_t value,
+		event::EventType eventType) {
+	auto &fbb = encoder.startEvent();
+	auto data =
+			(dataType == event::EventData_Flit) ?
+					fbb.CreateStruct(event::Flit(value)).Union() :
+					fbb.CreateStruct(event::Credit(value)).Union();
+
+	encoder.finishEvent(
+			event::CreateEvent(fbb, fbb.CreateString(name), time,
+					event::Priority_NORMAL_PRIORITY, 0, 0, dataType, data,
+					fbb.CreateString("router_0"), eventType));
+}
+
+// Receives all frames of the flushed cycle (name, flit, name, credit)
+static void receiveCycle(zmq::socket_t &subscriber) {
+	zmq::message_t frame;
+	for (int numOfFrames = 0; numOfFrames < 4; numOfFrames++) {
+		subscriber.recv(&frame);
+	}
+}
+
+static void runBenchmark(zmq::context_t &ctx, uint64_t numOfFlits,
+		bool zeroCopy) {
+	EventPublisher publisher(ctx);
+	EventEncoder encoder;
+	zmq::socket_t subscriber(ctx, ZMQ_SUB);
+	int hwm = 0;
+	subscriber.setsockopt(ZMQ_RCVHWM, &hwm, sizeof(hwm));
+
+	publisher.bindSocket(BENCH_ENDPOINT);
+	subscriber.connect(BENCH_ENDPOINT);
+	subscriber.setsockopt(ZMQ_SUBSCRIBE, "", 0);
+
+	// Topics of a router (flits) and of a processing element (credits):
+	// The name of the credits is too long to be stored in a ZMQ frame
+	std::string flitName = getLinkTopic("router_1", "East");
+	std::string creditName = getLinkTopic("processing_element_0",
+			"Credit_in_L++");
+	EventTopic flitTopic(flitName);
+	EventTopic creditTopic(creditName);
+
+	uint64_t allocations = 0;
+	std::chrono::nanoseconds duration(0);
+
+	// The first cycles are not measured (subscription, memory of the vectors)
+	const uint64_t numOfWarmupCycles = 1000;
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	for (uint64_t cycle = 0; cycle < numOfWarmupCycles + numOfFlits;
+			cycle++) {
+		uint64_t allocationsBefore = numOfAllocations.load();
+		auto start = std::chrono::steady_clock::now();
+
+		encodeEvent(encoder, "East", cycle, event::EventData_Flit,
+				uint32_t(cycle), event::EventType_East);
+		if (zeroCopy) {
+			publisher.queueEvent(flitTopic, encoder);
+		} else {
+			publisher.queueEvent(flitName, encoder.getBuffer(),
+					encoder.getSize());
+		}
+
+		encodeEvent(encoder, "Credit_in_L++", cycle, event::EventData_Credit, 1,
+				event::EventType_Credit_in_L);
+		if (zeroCopy) {
+			publisher.queueEvent(creditTopic, encoder);
+		} else {
+			publisher.queueEvent(creditName, encoder.getBuffer(),
+					encoder.getSize());
+		}
+
+		publisher.flushEvents();
+
+		if (cycle >= numOfWarmupCycles) {
+			duration += std::chrono::steady_clock::now() - start;
+			allocations += numOfAllocations.load() - allocationsBefore;
+		}
+
+		// The receiver releases the frames (not measured)
+		receiveCycle(subscriber);
+	}
+
+	std::cout << (zeroCopy ? "zero-copy" : "copy     ") << ": "
+			<< double(allocations) / numOfFlits << " allocations/flit, "
+			<< double(duration.count()) / numOfFlits << " ns/flit (flit and credit), "
+			<< encoder.getNumOfBuilders() << " builders" << std::endl;
+
+	subscriber.close();
+}
+
+int main(int argc, char* argv[]) {
+	uint64_t numOfFlits = 100000;
+	if (argc > 1) {
+		numOfFlits = std::strtoull(argv[1], nullptr, 10);
+	}
+
+	zmq::context_t ctx(1);
+	std::cout << "Publish " << numOfFlits << " flits (inproc)" << std::endl;
+	runBenchmark(ctx, numOfFlits, false);
+	runBenchmark(ctx, numOfFlits, true);
+
+	return 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <stdint.h>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "common/persistence/StateArchive.h"
+
+// Save and restore time of the savepoints of a few hundred models in the
+// state formats (see StateArchive.h). Each model has the fields of a model
+// (4 values); in the second run also a buffer of 1000 values (e.g., FIFOs).
+// The last run writes a series of savepoints (16 kB of state per model, 4
+// changed values per model and savepoint) as binary and as delta files.
+//
+// Usage: bench_savepoint [directory (default: /tmp/bench_savepoint)]
+//                        [number of models (default: 300)]
+
+// State of a model
+struct BenchModel {
+	uint64_t currentSimTime = 0;
+	uint32_t creditCount = 3;
+	double pir = 0.01;
+	uint64_t randomSeed = 42;
+	std::vector<uint32_t> buffer;
+
+	template<typename Archive>
+	void serialize(Archive& archive, const unsigned int) {
+		archive & boost::serialization::make_nvp("CurrentSimTime", currentSimTime);
+		archive & boost::serialization::make_nvp("CreditCount", creditCount);
+		archive & boost::serialization::make_nvp("Pir", pir);
+		archive & boost::serialization::make_nvp("RandomSeed", randomSeed);
+		archive & boost::serialization::make_nvp("Buffer", buffer);
+	}
+};
+
+static const char *getFormatName(StateFormat format) {
+	switch (format) {
+	case StateFormat::Binary:
+		return "binary";
+	case StateFormat::Delta:
+		return "delta ";
+	default:
+		return "xml   ";
+	}
+}
+
+static double getMilliseconds(std::chrono::steady_clock::duration duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static std::string getFilePath(const std::string &directory, size_t model) {
+	return directory + "/model_" + std::to_string(model) + ".config";
+}
+
+static void runBenchmark(const std::string &directory, size_t numOfModels,
+		size_t bufferSize, StateFormat format) {
+	std::vector<BenchModel> models(numOfModels);
+	for (size_t i = 0; i < numOfModels; i++) {
+		models[i].currentSimTime = 1000 * i;
+		models[i].buffer.assign(bufferSize, uint32_t(i));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < numOfModels; i++) {
+		saveStateArchive(getFilePath(directory, i), format, "Model", models[i]);
+	}
+	auto saveDuration = std::chrono::steady_clock::now() - start;
+
+	std::vector<BenchModel> restoredModels(numOfModels);
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < numOfModels; i++) {
+		loadStateArchive(getFilePath(directory, i), "Model", restoredModels[i]);
+	}
+	auto restoreDuration = std::chrono::steady_clock::now() - start;
+
+	std::cout << "  " << getFormatName(format) << ": save "
+			<< getMilliseconds(saveDuration) << " ms, restore "
+			<< getMilliseconds(restoreDuration) << " ms" << std::endl;
+}
+
+static uint64_t getDirectorySize(const std::string &directory) {
+	uint64_t size = 0;
+	for (auto &entry : boost::filesystem::directory_iterator(directory)) {
+		size += boost::filesystem::file_size(entry.path());
+	}
+	return size;
+}
+
+static void runSeriesBenchmark(const std::string &directory,
+		size_t numOfModels, StateFormat format) {
+	const size_t numOfSavepoints = 10;
+	std::vector<BenchModel> models(numOfModels);
+	std::vector<DeltaBase> deltaBases(numOfModels);
+	for (size_t i = 0; i < numOfModels; i++) {
+		models[i].buffer.assign(4096, uint32_t(i));
+	}
+
+	// The first savepoint is the base (not measured)
+	std::chrono::steady_clock::duration saveDuration(0);
+	std::chrono::steady_clock::duration restoreDuration(0);
+	uint64_t numOfBytes = 0;
+	for (size_t savepoint = 0; savepoint < numOfSavepoints; savepoint++) {
+		std::string savepointDirectory = directory + "/savepoint_"
+				+ std::to_string(savepoint);
+		boost::filesystem::create_directories(savepointDirectory);
+
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < numOfModels; i++) {
+			models[i].currentSimTime += 500;
+			for (size_t change = 0; change < 3; change++) {
+				models[i].buffer[(savepoint * 997 + change * 1361)
+						% models[i].buffer.size()]++;
+			}
+			saveStateArchive(getFilePath(savepointDirectory, i), format,
+					"Model", models[i], &deltaBases[i]);
+		}
+		auto savedTime = std::chrono::steady_clock::now();
+
+		BenchModel restoredModel;
+		for (size_t i = 0; i < numOfModels; i++) {
+			loadStateArchive(getFilePath(savepointDirectory, i), "Model",
+					restoredModel);
+		}
+
+		if (savepoint > 0) {
+			saveDuration += savedTime - start;
+			restoreDuration += std::chrono::steady_clock::now() - savedTime;
+			numOfBytes += getDirectorySize(savepointDirectory);
+		}
+	}
+
+	size_t numOfMeasuredSavepoints = numOfSavepoints - 1;
+	std::cout << "  " << getFormatName(format) << ": "
+			<< double(numOfBytes) / numOfMeasuredSavepoints / 1e6
+			<< " MB written, save "
+			<< getMilliseconds(saveDuration) / numOfMeasuredSavepoints
+			<< " ms, restore "
+			<< getMilliseconds(restoreDuration) / numOfMeasuredSavepoints
+			<< " ms" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	std::string directory = "/tmp/bench_savepoint";
+	size_t numOfModels = 300;
+	if (argc > 1) {
+		directory = argv[1];
+	}
+	if (argc > 2) {
+		numOfModels = std::strtoull(argv[2], nullptr, 10);
+	}
+	boost::filesystem::create_directories(directory);
+
+	for (size_t bufferSize : { 0, 1000 }) {
+		std::cout << numOfModels << " models, " << bufferSize
+				<< " buffered values per model:" << std::endl;
+		runBenchmark(directory, numOfModels, bufferSize, StateFormat::Xml);
+		runBenchmark(directory, numOfModels, bufferSize, StateFormat::Binary);
+	}
+
+	std::cout << numOfModels << " models, savepoints after the base "
+			<< "(average of 9):" << std::endl;
+	runSeriesBenchmark(directory + "/binary", numOfModels, StateFormat::Binary);
+	runSeriesBenchmark(directory + "/delta", numOfModels, StateFormat::Delta);
+
+	boost::filesystem::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <stdint.h>
+
+#include "common/scheduler/EventHeap.h"
+#include "common/scheduler/TimingWheel.h"
+
+// Cost of taking the next event and rescheduling it (periodic event) with
+// the future event list of the event queue model:
+// - heap: EventHeap (binary min-heap)
+// - sorted vector: event set, which is sorted after each rescheduled event
+//   (next event at the back), as the queue did before
+// and cost per expired and rescheduled event of periodic sources, which are
+// simulated in steps of 100 time units (as the queue does in each step):
+// - wheel: TimingWheel
+// - heap: EventHeap
+//
+// Usage: bench_scheduler [number of events ...] (default: 10000 100000 1000000)
+
+// Event of the queue model (name, data, timestamp, period)
+struct BenchEvent {
+	std::string name;
+	uint32_t data;
+	uint64_t timestamp;
+	uint32_t period;
+
+	uint64_t getTimestamp() const {
+		return timestamp;
+	}
+};
+
+static std::vector<BenchEvent> createEvents(size_t numOfEvents) {
+	std::mt19937_64 random(42);
+	std::uniform_int_distribution<uint32_t> periods(100, 100100);
+
+	std::vector<BenchEvent> events;
+	events.reserve(numOfEvents);
+	for (size_t i = 0; i < numOfEvents; i++) {
+		uint32_t period = periods(random);
+		events.push_back(
+				BenchEvent { "Event_" + std::to_string(i), uint32_t(i),
+						random() % period, period });
+	}
+	return events;
+}
+
+template<typename Operation>
+static double measure(uint64_t numOfOperations, Operation operation) {
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < numOfOperations; i++) {
+		operation();
+	}
+	std::chrono::nanoseconds duration = std::chrono::steady_clock::now()
+			- start;
+	return double(duration.count()) / numOfOperations;
+}
+
+static void runHeap(const std::vector<BenchEvent> &events) {
+	EventHeap<BenchEvent> heap;
+	heap.setEvents(events);
+
+	double ns = measure(1000000, [&heap]() {
+		BenchEvent event = heap.top();
+		heap.pop();
+		event.timestamp += event.period;
+		heap.push(event);
+	});
+
+	std::cout << "  heap:          " << ns << " ns/event" << std::endl;
+}
+
+static void runSortedVector(const std::vector<BenchEvent> &events) {
+	auto later = [](const BenchEvent &a, const BenchEvent &b) {
+		return a.timestamp > b.timestamp;
+	};
+
+	std::vector<BenchEvent> eventSet(events);
+	std::sort(eventSet.begin(), eventSet.end(), later);
+
+	// Each operation sorts all events, so only a few are measured
+	double ns = measure(20, [&eventSet, &later]() {
+		BenchEvent event = eventSet.back();
+		eventSet.pop_back();
+		event.timestamp += event.period;
+		eventSet.push_back(event);
+		std::sort(eventSet.begin(), eventSet.end(), later);
+	});
+
+	std::cout << "  sorted vector: " << ns << " ns/event" << std::endl;
+}
+
+#define BENCH_TIME_STEP 100
+
+// Simulates the steps and returns the time per expired event
+template<typename Step>
+static double measureSteps(uint64_t numOfSteps, Step step) {
+	uint64_t numOfExpiredEvents = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 1; i <= numOfSteps; i++) {
+		numOfExpiredEvents += step(i * BENCH_TIME_STEP);
+	}
+	std::chrono::nanoseconds duration = std::chrono::steady_clock::now()
+			- start;
+	return double(duration.count()) / std::max<uint64_t>(numOfExpiredEvents, 1);
+}
+
+static void runPeriodicWheel(const std::vector<BenchEvent> &events) {
+	TimingWheel<BenchEvent> wheel;
+	for (auto &event : events) {
+		wheel.insert(event);
+	}
+
+	std::vector<BenchEvent> dueEvents;
+	double ns = measureSteps(2000, [&wheel, &dueEvents](uint64_t time) {
+		dueEvents.clear();
+		wheel.advance(time, dueEvents);
+		for (auto &event : dueEvents) {
+			event.timestamp += event.period;
+			wheel.insert(event);
+		}
+		return dueEvents.size();
+	});
+
+	std::cout << "  wheel:         " << ns << " ns/event" << std::endl;
+}
+
+static void runPeriodicHeap(const std::vector<BenchEvent> &events) {
+	EventHeap<BenchEvent> heap;
+	heap.setEvents(events);
+
+	std::vector<BenchEvent> dueEvents;
+	double ns = measureSteps(2000, [&heap, &dueEvents](uint64_t time) {
+		dueEvents.clear();
+		while (!heap.empty() && heap.top().getTimestamp() <= time) {
+			dueEvents.push_back(heap.top());
+			heap.pop();
+		}
+		for (auto &event : dueEvents) {
+			event.timestamp += event.period;
+			heap.push(event);
+		}
+		return dueEvents.size();
+	});
+
+	std::cout << "  heap:          " << ns << " ns/event" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<size_t> numsOfEvents = { 10000, 100000, 1000000 };
+	if (argc > 1) {
+		numsOfEvents.clear();
+		for (int i = 1; i < argc; i++) {
+			numsOfEvents.push_back(std::strtoull(argv[i], nullptr, 10));
+		}
+	}
+
+	for (auto numOfEvents : numsOfEvents) {
+		std::cout << numOfEvents << " pending events "
+				<< "(take the next event and reschedule it):" << std::endl;
+		auto events = createEvents(numOfEvents);
+		runHeap(events);
+		runSortedVector(events);
+
+		std::cout << numOfEvents << " periodic sources "
+				<< "(2000 steps, expire and reschedule):" << std::endl;
+		runPeriodicWheel(events);
+		runPeriodicHeap(events);
+	}
+
+	return 0;
+}
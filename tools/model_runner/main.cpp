@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2018, German Aerospace Center (DLR)
+ *
+ * This file is part of the development version of FRASER.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Authors:
+ * - 2018, Annika Ofenloch (DLR RY-AVS)
+ */
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zmq.hpp>
+#include <pugixml.hpp>
+
+#include "configuration_server/ConfigurationServer.h"
+#include "simulation_model/SimulationModel.h"
+#include "router/RouterAdapter.h"
+#include "processing_element/ProcessingElement.h"
+#include "event_queue_1/Queue.h"
+
+// Runs all models with the given process attribute (hosts-configuration file) as
+// threads of one process. The models share one ZMQ context, so that they exchange
+// their events via inproc endpoints (connecting before binding requires ZeroMQ 4.2
+// or newer). The configuration server assigns the inproc endpoints.
+
+template<typename Model>
+void runModel(zmq::context_t &ctx, std::string name, std::string description) {
+	Model model(ctx, name, description);
+	try {
+		model.run();
+
+	} catch (zmq::error_t& e) {
+		std::cout << name << ": Interrupt received: Exit" << std::endl;
+	}
+}
+
+void runConfigurationServer(zmq::context_t &ctx, std::string configFilePath) {
+	ConfigurationServer configServerModel(ctx, configFilePath);
+	try {
+		configServerModel.run();
+
+	} catch (zmq::error_t& e) {
+		std::cout << "configuration_server: Interrupt received: Exit"
+				<< std::endl;
+	}
+}
+
+void runSimulationModel(zmq::context_t &ctx, std::string configPath,
+		bool createConfigFiles) {
+	SimulationModel simulation(ctx, "simulation_model",
+			"Simulation Environment");
+
+	if (createConfigFiles) {
+		std::cout << "Create default configuration files" << std::endl;
+		simulation.setConfigMode(true);
+		simulation.saveState(configPath);
+	} else {
+		simulation.loadState(configPath);
+		simulation.run();
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 5) {
+		std::cout << "<< Help >>" << std::endl;
+		std::cout << "--config-file CONFIG-FILE >> "
+				<< "Set path of models-configuration file" << std::endl;
+		std::cout << "--load-config CONFIG-PATH >> "
+				<< "Define path of configuration file/s" << std::endl;
+		std::cout << "--create-config-files CONFIG-PATH >> "
+				<< "Create default configuration files" << std::endl;
+		std::cout << "--process PROCESS-ID >> "
+				<< "Run the models with the given process attribute "
+				<< "(default: models without process attribute)" << std::endl;
+		return 0;
+	}
+
+	std::string configFilePath = "";
+	std::string configPath = "";
+	std::string processID = "";
+	bool createConfigFiles = false;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string option = static_cast<std::string>(argv[i]);
+		if (option == "--config-file") {
+			configFilePath = argv[i + 1];
+		} else if (option == "--load-config") {
+			configPath = argv[i + 1];
+		} else if (option == "--create-config-files") {
+			configPath = argv[i + 1];
+			createConfigFiles = true;
+		} else if (option == "--process") {
+			processID = argv[i + 1];
+		} else {
+			std::cout << " Invalid argument/s: " << option << std::endl;
+			return 0;
+		}
+	}
+
+	pugi::xml_document document;
+	if (!document.load_file(configFilePath.c_str())) {
+		std::cout << "Could not parse models-configuration file: "
+				<< configFilePath << std::endl;
+		return 0;
+	}
+
+	// The type of a model is the name of its folder within the models-folder
+	std::vector<std::pair<std::string, std::string>> models;
+	for (auto &modelNode : document.document_element().select_nodes(
+			".//Models/Model")) {
+		std::string name = modelNode.node().attribute("id").value();
+		std::string path = modelNode.node().attribute("path").value();
+		std::string type = path.substr(path.find_last_of('/') + 1);
+		std::string modelProcess = modelNode.node().attribute("process").value();
+
+		if (modelProcess != processID) {
+			continue;
+		}
+
+		if (type == "configuration_server" || type == "simulation_model"
+				|| type == "router" || type == "processing_element"
+				|| type == "event_queue_1") {
+			models.push_back( { name, type });
+		} else {
+			std::cout << name << " (" << type
+					<< ") has to be started separately" << std::endl;
+		}
+	}
+
+	zmq::context_t ctx(1);
+	std::vector<std::thread> modelThreads;
+
+	for (auto &model : models) {
+		std::string name = model.first;
+		std::string type = model.second;
+
+		if (type == "configuration_server") {
+			modelThreads.emplace_back(runConfigurationServer, std::ref(ctx),
+					configFilePath);
+		} else if (type == "simulation_model") {
+			modelThreads.emplace_back(runSimulationModel, std::ref(ctx),
+					configPath, createConfigFiles);
+		} else if (type == "router") {
+			modelThreads.emplace_back(runModel<RouterAdapter>, std::ref(ctx),
+					name, "Bonfire Router Model");
+		} else if (type == "processing_element") {
+			modelThreads.emplace_back(runModel<ProcessingElement>,
+					std::ref(ctx), name,
+					"PE for Router: Packet Generator for Sending and Packet Sink for Receiving Flits");
+		} else if (type == "event_queue_1") {
+			modelThreads.emplace_back(runModel<Queue>, std::ref(ctx), name,
+					"Queue includes the scheduled events.");
+		}
+	}
+
+	for (auto &modelThread : modelThreads) {
+		modelThread.join();
+	}
+
+	return 0;
+}